@@ -5,7 +5,7 @@
   * @author  D. Baines
   *
   * @brief   File contains constants, variables, and function definitions
-  *          for interfacing with an RLS Orbis SPI encoder.
+  *          for interfacing with an SPI absolute encoder such as the RLS Orbis.
   *
   * @version v1.0
   ******************************************************************************
@@ -28,10 +28,27 @@
 #include "encoder.hpp"
 
 
+/*************************************************************************************/
+/* STATIC MEMBERS                                                                    */
+/*************************************************************************************/
+
+/* Position reads ignore MOSI, so every streaming encoder of a variant can share one dummy tx ring */
+template<typename ENCODER_TRAITS>
+uint8_t SPIEncoder<ENCODER_TRAITS>::_streamTxBuffer[ENCODER_STREAM_SLOT_COUNT * ENCODER_FRAME_SIZE_IN_BYTES] = {0U};
+
+
 /*************************************************************************************/
 /* PRIVATE FUNCTION DEFINITIONS                                                      */
 /*************************************************************************************/
 
+/* The GPIOx macros are casts of the port base address, so the cast back is made here rather than at construction */
+template<typename ENCODER_TRAITS>
+GPIO_TypeDef* SPIEncoder<ENCODER_TRAITS>::getChipSelectPort(void)
+{
+  return (reinterpret_cast<GPIO_TypeDef*>(_chipSelectPortAddress));
+}
+
+
 /**
   * @brief  Increment driver error counter
   *
@@ -39,48 +56,428 @@
   *
   * @retval None
   */
-void Encoder::incrementErrorCount(OrbisDriverError_t driverError)
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::incrementErrorCount(EncoderDriverError_t driverError)
 {
   _errorCounts[driverError]++;
 }
 
 
 /**
-  * @brief  Checks the recieved packet for errors and decodes the payload into usable member structures/variables
+  * @brief  Adds a fetch outcome to the health window, telling the derived class if the
+  *         encoder was quarantined or restored
   *
-  * @param  packetIn: Union holding packet data as raw received bytes and data structures
+  * @param  fetchSucceeded: False for a transfer error, CRC failure or status error
   *
-  * @retval status_t: Success status of the packet processing
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::recordFetchHealth(bool fetchSucceeded)
+{
+  if (_health.record(fetchSucceeded))
+  {
+    healthChanged(_health.getState());
+  }
+}
+
+
+/**
+  * @brief  Publishes the latest sample to the shared position table and telemetry stream, if attached
+  *
+  * @param  sampleStatus:    Outcome of the latest sample
+  *
+  * @param  sampleTimestamp: Cycle count at which the sample was latched
+  *
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::publishSample(EncoderSampleStatus_t sampleStatus, uint32_t sampleTimestamp)
+{
+  if (_tableSlot.status != NULL)
+  {
+    /* The table only holds positions that passed their checks */
+    PUBLISH_TABLE_SAMPLE(_tableSlot, sampleStatus, _lastValidPosition, sampleTimestamp);
+  }
+
+  if (_telemetry != NULL)
+  {
+    /* The outcome alone would hide which of the Orbis error and warning bits were set */
+    _telemetry->addSample(_lastValidPosition, sampleStatus, _encoderStatus, sampleTimestamp);
+  }
+}
+
+
+/**
+  * @brief  Runs the attached filter chain over a sample, tracking its worst-case cost
+  *
+  * @param  rawPosition: Linearity corrected position
+  *
+  * @retval uint16_t: Filtered position, or the raw position if no filter is attached
   */
-status_t Encoder::processReceivedPacket(OrbisPositionReceivePacket_t packetIn)
+template<typename ENCODER_TRAITS>
+uint16_t SPIEncoder<ENCODER_TRAITS>::filterPosition(uint16_t rawPosition)
 {
-  OrbisPositionPayload_t positionPayload = {0};
+  if (_positionFilter == NULL)
+  {
+    return (rawPosition);
+  }
 
-  uint8_t crcResult = ~(CRC8::calculateCRC8(packetIn.asBytes, ORBIS_POSITION_PACKET_SIZE_IN_BYTES - ORBIS_CRC_SIZE_IN_BYTES));
+  uint32_t filterStart      = GET_CYCLE_COUNT();
+  uint16_t filteredPosition = _positionFilter->apply(rawPosition);
+  uint32_t filterCycles     = GET_CYCLE_COUNT() - filterStart;
 
-  if (crcResult == packetIn.asData.OrbisCRC)
+  if (filterCycles > _filterWorstCaseCycles)
   {
-    positionPayload.asUINT16 = swapUINT16(packetIn.asData.positionPayload);
+    _filterWorstCaseCycles = filterCycles;
+  }
+
+  return (filteredPosition);
+}
+
+
+/**
+  * @brief  Checks the recieved packet CRC and extracts the position and status fields
+  *
+  * @param  packetIn:   Raw frame bytes as received
+  *
+  * @param  payloadOut: Decoded payload holding the encoder status and position
+  *
+  * @retval status_t: STATUS_ERROR if the CRC check failed
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::decodePacket(EncoderFrame_t packetIn, EncoderPayload_t* payloadOut)
+{
+  uint8_t  crcResult = ENCODER_CRC.calculateCRC8(packetIn.asBytes, ENCODER_TRAITS::CRC_BYTE_INDEX, ENCODER_TRAITS::CRC_INITIAL_VALUE) ^ ENCODER_TRAITS::CRC_FINAL_XOR;
+  uint32_t frameWord = FrameLayout_t::toWord(packetIn.asBytes);
+
+  /* Shifts and masks are compile-time constants for each variant */
+  payloadOut->position = FrameLayout_t::position(frameWord);
+  payloadOut->status   = FrameLayout_t::status(frameWord);
+
+  return ((crcResult == FrameLayout_t::CRC(frameWord)) ? STATUS_OK : STATUS_ERROR);
+}
+
+
+/**
+  * @brief  Checks the recieved packet for errors and decodes the payload into usable member structures/variables
+  *
+  * @param  packetIn:        Raw frame bytes as received
+  *
+  * @param  sampleTimestamp: Cycle count at which the encoder latched the sample
+  *
+  * @retval status_t: Success status of the packet processing
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::processReceivedPacket(EncoderFrame_t packetIn, uint32_t sampleTimestamp)
+{
+  EncoderPayload_t positionPayload = {0U, 0U};
 
-    _orbisStatus = static_cast<OrbisStatus_t>(positionPayload.asData.status);
+  if (decodePacket(packetIn, &positionPayload) == STATUS_OK)
+  {
+    _encoderStatus = positionPayload.status;
 
-    if (_orbisStatus != ORBIS_STATUS_OK)
+    if (_encoderStatus != ENCODER_TRAITS::STATUS_OK)
     {
-      incrementErrorCount(ORBIS_DRIVER_ERROR_STATUS);
+      incrementErrorCount(ENCODER_DRIVER_ERROR_STATUS);
+      publishSample(ENCODER_SAMPLE_STATUS_ERROR, sampleTimestamp);
       return (STATUS_ERROR);
     }
     else
     {
-      _lastValidPosition = positionPayload.asData.position;
+      _lastRawPosition   = _linearityTable.apply(positionPayload.position);
+      _lastValidPosition = filterPosition(_lastRawPosition);
+
+      _previousSample    = _latestSample;
+      _latestSample      = { .position = _lastValidPosition, .timestamp = sampleTimestamp };
+
+      if (_validSampleCount < 2U) _validSampleCount++;
+
+      publishSample(ENCODER_SAMPLE_OK, sampleTimestamp);
+
       return (STATUS_OK);
     }
   }
 
   else
   {
-    incrementErrorCount(ORBIS_DRIVER_ERROR_CRC_FAIL);
+    incrementErrorCount(ENCODER_DRIVER_ERROR_CRC_FAIL);
+    publishSample(ENCODER_SAMPLE_CRC_FAIL, sampleTimestamp);
+    return (STATUS_ERROR);
+  }
+}
+
+
+/**
+  * @brief  Copies a raw frame out of the stream ring
+  *
+  * @param  slot: Index of the stream slot to copy
+  *
+  * @retval EncoderFrame_t: Frame holding the slot's raw bytes
+  */
+template<typename ENCODER_TRAITS>
+typename SPIEncoder<ENCODER_TRAITS>::EncoderFrame_t SPIEncoder<ENCODER_TRAITS>::getStreamSlot(uint8_t slot)
+{
+  EncoderFrame_t packet;
+
+  for (uint8_t byte = 0U; byte < ENCODER_FRAME_SIZE_IN_BYTES; byte++)
+  {
+    packet.asBytes[byte] = _streamRxBuffer[(slot * ENCODER_FRAME_SIZE_IN_BYTES) + byte];
+  }
+
+  return (packet);
+}
+
+
+/**
+  * @brief  Runs CRC and decode over a batch of filled stream slots
+  *
+  * @param  firstSlot: Index of the first slot in the batch
+  *
+  * @param  slotCount: Number of slots in the batch
+  *
+  * @retval status_t: Processing status of the newest slot in the batch
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::processStreamSlots(uint8_t firstSlot, uint8_t slotCount)
+{
+  status_t slotStatus = STATUS_ERROR;
+
+  /* Stream frames have no per-frame chip select event, so spread timestamps evenly back from this batch event */
+  uint32_t batchTimestamp = GET_CYCLE_COUNT();
+  uint32_t slotPeriod     = (_lastStreamEventTime == 0U) ? 0U : ((batchTimestamp - _lastStreamEventTime) / slotCount);
+
+  _lastStreamEventTime = batchTimestamp;
+
+  for (uint8_t slot = 0U; slot < slotCount; slot++)
+  {
+    uint32_t slotTimestamp = batchTimestamp - ((slotCount - 1U - slot) * slotPeriod);
+
+    slotStatus = processReceivedPacket(getStreamSlot(firstSlot + slot), slotTimestamp);
+  }
+
+  return (slotStatus);
+}
+
+
+/**
+  * @brief  Publishes a raw frame for decodeDeferredFrame() - the sequence is odd while the
+  *         fields are written, so the reader can tell a torn frame from a finished one
+  *
+  * @note   Completion ISR only. The ISR runs to completion over the reader, so the
+  *         reader never sees the sequence change under it unless it preempts the ISR.
+  *
+  * @param  transferFailed: True if the transfer failed and rawFrame holds nothing
+  * @param  rawFrame:       Frame bytes packed into a word, first byte highest
+  * @param  rawTimestamp:   Transfer timestamp of the frame
+  *
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::publishRawFrame(bool transferFailed, uint32_t rawFrame, uint32_t rawTimestamp)
+{
+  _rawSequence = _rawSequence + 1U;
+  __DMB();
+
+  _rawTransferFailed = transferFailed;
+  _rawFrame          = rawFrame;
+  _rawTimestamp      = rawTimestamp;
+
+  __DMB();
+  _rawSequence = _rawSequence + 1U;
+}
+
+
+/**
+  * @brief  Decodes the newest raw frame published by the ISR, once per frame
+  *
+  * @note   Runs in the reader's context. Reads should come from a single context, as
+  *         the memoised result is not shared safely between preempting readers.
+  *
+  * @param  None
+  *
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::decodeDeferredFrame(void)
+{
+  if (!_deferredDecode)
+  {
+    return;
+  }
+
+  uint32_t sequence        = 0U;
+  bool     transferFailed  = false;
+  uint32_t rawFrame        = 0U;
+  uint32_t rawTimestamp    = 0U;
+  bool     frameConsistent = false;
+
+  for (uint8_t attempt = 0U; (attempt < ENCODER_RAW_FRAME_READ_ATTEMPTS) && !frameConsistent; attempt++)
+  {
+    sequence = _rawSequence;
+
+    /* Odd while the ISR is publishing */
+    if ((sequence & 1U) != 0U)
+    {
+      continue;
+    }
+
+    __DMB();
+
+    transferFailed = _rawTransferFailed;
+    rawFrame       = _rawFrame;
+    rawTimestamp   = _rawTimestamp;
+
+    __DMB();
+
+    frameConsistent = (sequence == _rawSequence);
+  }
+
+  /* No quiet window - the reader has preempted the ISR, so the frame is picked up on the next read */
+  if (!frameConsistent)
+  {
+    return;
+  }
+
+  /* Memoised - frames nobody reads are never decoded, and re-reads of a frame cost nothing */
+  if (sequence == _decodedSequence)
+  {
+    return;
+  }
+
+  _decodedSequence = sequence;
+
+  /* The ISR only counted the transfer error - the sample and health verdict belong to the reader */
+  if (transferFailed)
+  {
+    publishSample(ENCODER_SAMPLE_TRANSFER_ERROR, rawTimestamp);
+    recordFetchHealth(false);
+    return;
+  }
+
+  EncoderFrame_t rawPacket;
+
+  for (uint8_t byte = 0U; byte < ENCODER_FRAME_SIZE_IN_BYTES; byte++)
+  {
+    rawPacket.asBytes[byte] = static_cast<uint8_t>(rawFrame >> ((ENCODER_FRAME_SIZE_IN_BYTES - 1U - byte) * BITS_IN_A_BYTE));
+  }
+
+  recordFetchHealth(processReceivedPacket(rawPacket, rawTimestamp) == STATUS_OK);
+}
+
+
+/**
+  * @brief  Queues a position fetch job on the encoder's bus
+  *
+  * @param  None
+  *
+  * @retval status_t: STATUS_ERROR if the job could not be queued, or was skipped under quarantine
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::queuePositionFetch(void)
+{
+  _hasFetched = true;
+
+  /* A quarantined encoder only takes a bus slot for its probe fetches */
+  if (!_health.admit())
+  {
+    return (STATUS_ERROR);
+  }
+
+  SPIJob_t positionFetchSPIJob = { .SPIObject           = SPI::getObjectContext(),
+                                   .SPIBusID            = _SPIBusID,
+                                   .csPort              = getChipSelectPort(),
+                                   .csPin               = _chipSelectPin,
+                                   .txBuffer            = _positionTxBuffer,
+                                   .rxBuffer            = _positionRxPacket.asBytes,
+                                   .length              = ENCODER_FRAME_SIZE_IN_BYTES,
+                                   .chainedSegments     = NULL,
+                                   .chainedSegmentCount = 0U,
+                                   .queuedTimestamp     = 0U
+                                 };
+
+  if (SPI::transmitReceiveAsync(positionFetchSPIJob) != STATUS_OK)
+  {
+    incrementErrorCount(ENCODER_DRIVER_ERROR_SPI_BAD_JOB);
+    return (STATUS_ERROR);
+  }
+
+  return (STATUS_OK);
+}
+
+
+/**
+  * @brief  Parks an awaiting task on the fetch waiter and queues its fetch
+  *
+  * @param  handle: Task suspended in co_await fetchPosition()
+  *
+  * @retval status_t: STATUS_ERROR if a task is already waiting or the job could not be queued
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::startAwaitedFetch(Task::handle_t handle)
+{
+  if (_fetchWaiter.attach(handle) != STATUS_OK)
+  {
+    return (STATUS_ERROR);
+  }
+
+  if (queuePositionFetch() != STATUS_OK)
+  {
+    _fetchWaiter.detach();
     return (STATUS_ERROR);
   }
+
+  return (STATUS_OK);
+}
+
+
+/**
+  * @brief  Updates the sample timing statistics with a chip select edge timestamp
+  *
+  * @param  sampleTimestamp: Cycle count at which chip select was asserted for the sample
+  *
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::recordSampleTiming(uint32_t sampleTimestamp)
+{
+  if (_hasSampleTimestamp)
+  {
+    _sampleIntervalTiming.add(sampleTimestamp - _lastSampleTimestamp);
+  }
+
+  /* The bus stamps each job as it is queued, so queued fetches each measure from their own trigger */
+  int32_t fetchLatency = static_cast<int32_t>(sampleTimestamp - SPI::getQueuedTimestamp());
+
+  if ((fetchLatency < 0) || (static_cast<uint32_t>(fetchLatency) > ENCODER_MAX_FETCH_LATENCY))
+  {
+    _droppedLatencyCount++;
+  }
+  else
+  {
+    _fetchLatencyTiming.add(static_cast<uint32_t>(fetchLatency));
+  }
+
+  _lastSampleTimestamp = sampleTimestamp;
+  _hasSampleTimestamp  = true;
+}
+
+
+/**
+  * @brief  Signed shortest step between two positions, accounting for the wrap at one turn
+  *
+  * @param  fromPosition: Earlier position
+  *
+  * @param  toPosition:   Later position
+  *
+  * @retval int16_t: Step in counts, in the range of +/- half a turn
+  */
+template<typename ENCODER_TRAITS>
+int16_t SPIEncoder<ENCODER_TRAITS>::wrappedPositionStep(uint16_t fromPosition, uint16_t toPosition)
+{
+  const uint8_t signShift = 16U - ENCODER_POSITION_RESOLUTION;
+
+  /* Move the 14-bit difference to the top of an int16_t, then shift back to sign extend it */
+  return (static_cast<int16_t>(static_cast<uint16_t>(toPosition - fromPosition) << signShift) >> signShift);
 }
 
 
@@ -89,7 +486,30 @@ status_t Encoder::processReceivedPacket(OrbisPositionReceivePacket_t packetIn)
 /*************************************************************************************/
 
 /**
-  * @brief  Constructor for encoder object - calls constructors for SPI and CRC base classes
+  * @brief  Constructor for an encoder whose chip select port is only known at run time.
+  *         Encoders listed in SPI_DEVICE_TOPOLOGY should be built from their SPIDeviceID_t.
+  *
+  * @param  chipSelectPort: Encoder GPIO chip select port
+  *
+  * @param  chipSelectPin:  Encoder GPIO chip select pin
+  *
+  * @param  SPIBusID:       Encoder SPI bus ID
+  *
+  * @retval None
+  */
+template<typename ENCODER_TRAITS>
+SPIEncoder<ENCODER_TRAITS>::SPIEncoder(GPIO_TypeDef* chipSelectPort, uint16_t chipSelectPin, SPIBusID_t SPIBusID):
+SPIEncoder(SPIDeviceDescriptor_t{ .SPIBusID      = SPIBusID,
+                                  .csPortAddress = reinterpret_cast<uintptr_t>(chipSelectPort),
+                                  .csPin         = chipSelectPin })
+{
+
+}
+
+
+/**
+  * @brief  Constructor for an encoder with its own SPI clock/mode, applied by the bus
+  *         whenever this encoder's jobs follow a device with different settings
   *
   * @param  chipSelectPort: Encoder GPIO chip select port
   *
@@ -97,14 +517,19 @@ status_t Encoder::processReceivedPacket(OrbisPositionReceivePacket_t packetIn)
   *
   * @param  SPIBusID:       Encoder SPI bus ID
   *
+  * @param  busConfig:      SPI prescaler, mode and frame size for this encoder
+  *
   * @retval None
   */
-Encoder::Encoder(GPIO_TypeDef* chipSelectPort, uint16_t chipSelectPin, SPIBusID_t SPIBusID):
-SPI(), CRC8(ORBIS_CRC_POLYNOMIAL)
+template<typename ENCODER_TRAITS>
+SPIEncoder<ENCODER_TRAITS>::SPIEncoder(GPIO_TypeDef* chipSelectPort, uint16_t chipSelectPin, SPIBusID_t SPIBusID, SPI::SPIBusConfig_t busConfig):
+SPIEncoder(SPIDeviceDescriptor_t{ .SPIBusID      = SPIBusID,
+                                  .csPortAddress = reinterpret_cast<uintptr_t>(chipSelectPort),
+                                  .csPin         = chipSelectPin,
+                                  .hasBusConfig  = true,
+                                  .busConfig     = busConfig })
 {
-  _chipSelectPort  = chipSelectPort;
-  _chipSelectPin   = chipSelectPin;
-  _SPIBusID        = SPIBusID;
+
 }
 
 
@@ -113,31 +538,42 @@ SPI(), CRC8(ORBIS_CRC_POLYNOMIAL)
   *
   * @warning Transfer will be added to a queue at lower levels so will
   *          not start instantly if the queue is not empty.
+  *          While the encoder is quarantined most triggers are skipped,
+  *          see setHealthPolicy().
   *
   * @param   None
   *
   * @retval  None
   */
-void Encoder::triggerPositionFetch(void)
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::triggerPositionFetch(void)
 {
-  SPIJob_t positionFetchSPIJob = { .SPIObject = SPI::getObjectContext(),
-                                   .SPIBusID  = _SPIBusID,
-                                   .csPort    = _chipSelectPort,
-                                   .csPin     = _chipSelectPin,
-                                   .txBuffer  = _positionTxBuffer,
-                                   .rxBuffer  = _positionRxPacket.asBytes,
-                                   .length    = ORBIS_POSITION_PACKET_SIZE_IN_BYTES
-                                 };
+  queuePositionFetch();
+}
 
-  if (SPI::transmitReceiveAsync(positionFetchSPIJob) != STATUS_OK)
-  {
-    incrementErrorCount(ORBIS_DRIVER_ERROR_SPI_BAD_JOB);
-  }
+
+/**
+  * @brief   Builds an awaitable position fetch. co_await it from a Task to queue a fetch
+  *          and resume once the sample has been processed - read it with
+  *          getLastValidPosition().
+  *
+  * @warning One task may await a fetch per encoder at a time - a second co_await returns
+  *          STATUS_ERROR at once. A fetch queued by triggerPositionFetch() which completes
+  *          first also resumes the waiting task.
+  *
+  * @param   None
+  *
+  * @retval  PositionFetchAwaiter: Awaitable whose co_await yields the fetch status_t
+  */
+template<typename ENCODER_TRAITS>
+typename SPIEncoder<ENCODER_TRAITS>::PositionFetchAwaiter SPIEncoder<ENCODER_TRAITS>::fetchPosition(void)
+{
+  return (PositionFetchAwaiter(this));
 }
 
 
 /**
-  * @brief   Returns the last valid position successfully received from the RLSOrbis
+  * @brief   Returns the last valid position successfully received from the encoder
   *
   * @warning The position return may not be up-to-date if the position fetch has not
   *          recently been triggered or the SPI transactions have failed
@@ -146,41 +582,611 @@ void Encoder::triggerPositionFetch(void)
   *
   * @retval  uint16_t: Last valid encoder position
   */
-uint16_t Encoder::getLastValidPosition(void)
+template<typename ENCODER_TRAITS>
+uint16_t SPIEncoder<ENCODER_TRAITS>::getLastValidPosition(void)
 {
+  decodeDeferredFrame();
+
   return (_lastValidPosition);
 }
 
-/*************************************************************************************/
-/* CALLBACK HANDLERS                                                                 */
-/*************************************************************************************/
 
 /**
-  * @brief   Callback from SPI base class called when a transaction is completed successfully
+  * @brief   Returns the last valid position before the attached filter chain ran
   *
   * @param   None
   *
-  * @retval  None
+  * @retval  uint16_t: Last valid linearity corrected, unfiltered encoder position
   */
-void Encoder::transmitReceiveComplete(void)
+template<typename ENCODER_TRAITS>
+uint16_t SPIEncoder<ENCODER_TRAITS>::getLastRawPosition(void)
 {
-  status_t receiveStatus = processReceivedPacket(_positionRxPacket);
+  decodeDeferredFrame();
 
-  positionFetchComplete(receiveStatus);
+  return (_lastRawPosition);
 }
 
 
 /**
-  * @brief   Callback from SPI base class called when a transaction has failed
+  * @brief   Estimates the position at a given time by extrapolating from the last two samples
   *
-  * @param   None
+  * @warning Assumes less than half a turn between consecutive samples. The estimate is
+  *          flagged invalid if either the sample spacing or the extrapolation distance
+  *          exceeds the prediction horizon, or fewer than two samples have been received.
   *
-  * @retval  None
+  * @param   timestamp: Cycle count (see GET_CYCLE_COUNT) to estimate the position at
+  *
+  * @retval  PositionEstimate_t: Estimated position and its validity. The latest sample
+  *                              is returned when the estimate is invalid.
   */
-void Encoder::transferError(void)
+template<typename ENCODER_TRAITS>
+typename SPIEncoder<ENCODER_TRAITS>::PositionEstimate_t SPIEncoder<ENCODER_TRAITS>::getPositionAt(uint32_t timestamp)
 {
-  incrementErrorCount(ORBIS_DRIVER_ERROR_SPI_TRANSFER);
-}
+  decodeDeferredFrame();
+
+  /* Copy both samples together so the bus ISR cannot update one between the reads */
+  uint32_t basepri = SPI::enterBusCriticalSection(_SPIBusID);
+
+  EncoderSample_t latestSample     = _latestSample;
+  EncoderSample_t previousSample   = _previousSample;
+  uint8_t       validSampleCount = _validSampleCount;
+
+  SPI::exitBusCriticalSection(_SPIBusID, basepri);
+
+  PositionEstimate_t estimate = { .position = latestSample.position, .valid = false };
+
+  uint32_t sampleInterval    = latestSample.timestamp - previousSample.timestamp;
+  int32_t  extrapolationTime = static_cast<int32_t>(timestamp - latestSample.timestamp);
+
+  if ((validSampleCount < 2U)                                         ||
+      (sampleInterval == 0U)                                          ||
+      (sampleInterval > _predictionHorizon)                           ||
+      (extrapolationTime >  static_cast<int32_t>(_predictionHorizon)) ||
+      (extrapolationTime < -static_cast<int32_t>(sampleInterval))       )
+  {
+    return (estimate);
+  }
+
+  int16_t positionStep  = wrappedPositionStep(previousSample.position, latestSample.position);
+
+  /* Bounded horizon keeps step * time well inside 64 bits */
+  int32_t extrapolation = static_cast<int32_t>((static_cast<int64_t>(positionStep) * extrapolationTime) / static_cast<int64_t>(sampleInterval));
+
+  estimate.position = static_cast<uint16_t>(latestSample.position + extrapolation) & ((1U << ENCODER_POSITION_RESOLUTION) - 1U);
+  estimate.valid    = true;
+
+  return (estimate);
+}
+
+
+/**
+  * @brief   Sets the furthest the position may be extrapolated, and the oldest sample
+  *          spacing trusted for a velocity estimate
+  *
+  * @param   horizonCycles: Prediction horizon in core clock cycles
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::setPredictionHorizon(uint32_t horizonCycles)
+{
+  _predictionHorizon = horizonCycles;
+}
+
+
+/**
+  * @brief   Selects deferred decode, where the completion ISR only publishes the raw frame
+  *          and CRC/decode run on the first read of each new sample
+  *
+  * @warning In deferred mode positionFetchComplete() reports the transfer only - a frame
+  *          failing CRC or status checks is found (and counted) when it is read. Error
+  *          counts, the position table, telemetry and the health window are only updated
+  *          for frames read, so an encoder nobody reads is never quarantined.
+  *
+  * @param   deferredDecode: True to defer decoding to the reader
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::setDeferredDecode(bool deferredDecode)
+{
+  _deferredDecode = deferredDecode;
+}
+
+
+/**
+  * @brief   Returns the cycle count at which chip select was asserted for the latest
+  *          fetched sample, i.e. when the encoder latched it
+  *
+  * @param   None
+  *
+  * @retval  uint32_t: Sample timestamp (see GET_CYCLE_COUNT)
+  */
+template<typename ENCODER_TRAITS>
+uint32_t SPIEncoder<ENCODER_TRAITS>::getLastSampleTimestamp(void)
+{
+  return (_lastSampleTimestamp);
+}
+
+
+/**
+  * @brief   Returns statistics on the interval between samples and on the delay from
+  *          triggerPositionFetch() to the sample being latched, both in cycles
+  *
+  * @note    Only one-shot fetches are measured - streamed frames have no chip select timestamp.
+  *          Latencies that are negative or beyond ENCODER_MAX_FETCH_LATENCY are counted, not summarised.
+  *
+  * @param   None
+  *
+  * @retval  SampleTimingReport_t: Interval and latency summaries since the last reset
+  */
+template<typename ENCODER_TRAITS>
+typename SPIEncoder<ENCODER_TRAITS>::SampleTimingReport_t SPIEncoder<ENCODER_TRAITS>::getSampleTiming(void)
+{
+  /* Snapshot under the bus lock so the completion ISR cannot update midway */
+  uint32_t         basepri              = SPI::enterBusCriticalSection(_SPIBusID);
+
+  TimingStatistics sampleIntervalTiming = _sampleIntervalTiming;
+  TimingStatistics fetchLatencyTiming   = _fetchLatencyTiming;
+  uint32_t         droppedLatencyCount  = _droppedLatencyCount;
+
+  SPI::exitBusCriticalSection(_SPIBusID, basepri);
+
+  SampleTimingReport_t sampleTimingReport = { .sampleInterval      = sampleIntervalTiming.summarise(),
+                                              .fetchLatency        = fetchLatencyTiming.summarise(),
+                                              .droppedLatencyCount = droppedLatencyCount
+                                            };
+
+  return (sampleTimingReport);
+}
+
+
+/**
+  * @brief   Clears the sample timing statistics
+  *
+  * @param   histogramBinWidth: Width of each histogram bin in cycles
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::resetSampleTiming(uint32_t histogramBinWidth)
+{
+  uint32_t basepri = SPI::enterBusCriticalSection(_SPIBusID);
+
+  _sampleIntervalTiming.reset(histogramBinWidth);
+  _fetchLatencyTiming.reset(histogramBinWidth);
+  _droppedLatencyCount = 0U;
+  _hasSampleTimestamp  = false;
+
+  SPI::exitBusCriticalSection(_SPIBusID, basepri);
+}
+
+
+/**
+  * @brief   Replays one device's frames from a capture dump through the normal decode
+  *          path as fast as possible, reproducing CRC/status statistics offline
+  *
+  * @warning Replay updates the position and error counts as live samples would, so it runs on
+  *          a separate replay instance (see Tools/captureReplay.cpp). An encoder which has
+  *          fetched, or has a position table or telemetry attached, refuses and replays nothing.
+  *
+  * @param   captureDump: Dump produced by FrameCapture::dump()
+  *
+  * @param   length:      Length of the dump in bytes
+  *
+  * @param   deviceID:    Captured device to replay (see CHIP_SELECT_DEVICE_ID)
+  *
+  * @retval  ReplayStatistics_t: Frame counts by outcome and the cycles spent decoding
+  */
+template<typename ENCODER_TRAITS>
+typename SPIEncoder<ENCODER_TRAITS>::ReplayStatistics_t SPIEncoder<ENCODER_TRAITS>::replayCapture(const uint8_t* captureDump, uint32_t length, uint8_t deviceID)
+{
+  ReplayStatistics_t replayStatistics = {0U, 0U, 0U, 0U, 0U};
+
+  if (_hasFetched || (_tableSlot.status != NULL) || (_telemetry != NULL))
+  {
+    return (replayStatistics);
+  }
+
+  if ((captureDump == NULL)                                                 ||
+      (length < FRAME_CAPTURE_HEADER_SIZE)                                  ||
+      (captureDump[0] != FRAME_CAPTURE_MAGIC_0)                             ||
+      (captureDump[1] != FRAME_CAPTURE_MAGIC_1)                             ||
+      (captureDump[2] != FRAME_CAPTURE_FORMAT_VERSION)                        )
+  {
+    return (replayStatistics);
+  }
+
+  uint32_t CRCFailsStart = _errorCounts[ENCODER_DRIVER_ERROR_CRC_FAIL];
+  uint32_t statusStart   = _errorCounts[ENCODER_DRIVER_ERROR_STATUS];
+  uint32_t replayStart   = GET_CYCLE_COUNT();
+  uint32_t offset        = FRAME_CAPTURE_HEADER_SIZE;
+
+  while ((length - offset) >= FRAME_CAPTURE_RECORD_HEADER_SIZE)
+  {
+    const uint8_t* record      = &captureDump[offset];
+    uint8_t        frameLength = record[FRAME_CAPTURE_OFFSET_LENGTH];
+
+    if ((length - offset) < static_cast<uint32_t>(FRAME_CAPTURE_RECORD_HEADER_SIZE + frameLength))
+    {
+      break;
+    }
+
+    offset += FRAME_CAPTURE_RECORD_HEADER_SIZE + frameLength;
+
+    if ((record[FRAME_CAPTURE_OFFSET_DEVICE_ID] != deviceID) || (frameLength != ENCODER_FRAME_SIZE_IN_BYTES))
+    {
+      continue;
+    }
+
+    EncoderFrame_t replayPacket;
+
+    for (uint8_t byte = 0U; byte < ENCODER_FRAME_SIZE_IN_BYTES; byte++)
+    {
+      replayPacket.asBytes[byte] = record[FRAME_CAPTURE_OFFSET_FRAME + byte];
+    }
+
+    uint32_t timestamp = static_cast<uint32_t>(record[FRAME_CAPTURE_OFFSET_TIMESTAMP])                                 |
+                         (static_cast<uint32_t>(record[FRAME_CAPTURE_OFFSET_TIMESTAMP + 1U]) << BITS_IN_A_BYTE)        |
+                         (static_cast<uint32_t>(record[FRAME_CAPTURE_OFFSET_TIMESTAMP + 2U]) << (2U * BITS_IN_A_BYTE)) |
+                         (static_cast<uint32_t>(record[FRAME_CAPTURE_OFFSET_TIMESTAMP + 3U]) << (3U * BITS_IN_A_BYTE));
+
+    if (processReceivedPacket(replayPacket, timestamp) == STATUS_OK)
+    {
+      replayStatistics.validCount++;
+    }
+
+    replayStatistics.frameCount++;
+  }
+
+  replayStatistics.cycles           = GET_CYCLE_COUNT() - replayStart;
+  replayStatistics.CRCFailCount     = _errorCounts[ENCODER_DRIVER_ERROR_CRC_FAIL] - CRCFailsStart;
+  replayStatistics.statusErrorCount = _errorCounts[ENCODER_DRIVER_ERROR_STATUS]   - statusStart;
+
+  return (replayStatistics);
+}
+
+
+/**
+  * @brief   Attaches this encoder to a slot of a shared position table, which the
+  *          completion ISR then writes every sample into
+  *
+  * @warning Attach before position fetches start - the ISR reads the slot without locking
+  *
+  * @param   tableSlot: Slot from EncoderPositionTable::getSlot()
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::attachPositionTable(EncoderTableSlot_t tableSlot)
+{
+  _tableSlot = tableSlot;
+}
+
+
+/**
+  * @brief   Attaches a telemetry stream which every sample is then compressed into
+  *
+  * @warning Encoding, and the stream's bufferReady() when a buffer fills, run in the
+  *          completion ISR. Attach before position fetches start.
+  *
+  * @param   telemetry: Telemetry encoder to feed, or NULL to detach
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::attachTelemetry(TelemetryEncoder* telemetry)
+{
+  _telemetry = telemetry;
+}
+
+
+/**
+  * @brief   Attaches a filter chain run on every valid sample after the CRC, status and
+  *          linearity steps. getLastValidPosition() then returns the filtered position
+  *          and getLastRawPosition() the unfiltered one.
+  *
+  * @warning Filtering runs in the completion ISR, so keep chains short - check the cost
+  *          with getFilterWorstCaseCycles(). The filter is reset on attach.
+  *
+  * @param   positionFilter: Filter chain to run, or NULL to detach
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::attachPositionFilter(PositionFilter* positionFilter)
+{
+  uint32_t basepri = SPI::enterBusCriticalSection(_SPIBusID);
+
+  if (positionFilter != NULL)
+  {
+    positionFilter->reset();
+  }
+
+  _positionFilter        = positionFilter;
+  _filterWorstCaseCycles = 0U;
+
+  SPI::exitBusCriticalSection(_SPIBusID, basepri);
+}
+
+
+/**
+  * @brief   Returns the most cycles one sample has spent in the filter chain since it
+  *          was attached, including the cycle counter reads
+  *
+  * @param   None
+  *
+  * @retval  uint32_t: Worst-case filter cost in cycles
+  */
+template<typename ENCODER_TRAITS>
+uint32_t SPIEncoder<ENCODER_TRAITS>::getFilterWorstCaseCycles(void)
+{
+  return (_filterWorstCaseCycles);
+}
+
+
+/**
+  * @brief   Loads the per-unit linearity correction applied to every decoded position
+  *
+  * @warning The blob is used in place so must remain valid, e.g. held in flash
+  *
+  * @param   calibrationBlob: Calibration blob fitted by the host calibration tool
+  *
+  * @param   length:          Length of the blob in bytes
+  *
+  * @retval  status_t: STATUS_ERROR if the blob is malformed or not fitted for this encoder
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::loadLinearityCalibration(const uint8_t* calibrationBlob, uint32_t length)
+{
+  return (_linearityTable.load(calibrationBlob, length));
+}
+
+
+/**
+  * @brief   Sets the calibrated offset between encoder zero and electrical zero
+  *
+  * @param   electricalAngleOffset: Electrical angle, as a 16-bit fraction of a turn,
+  *                                 read at the rotor's electrical zero
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::setElectricalAngleOffset(uint16_t electricalAngleOffset)
+{
+  _electricalAngleOffset = electricalAngleOffset;
+}
+
+
+/**
+  * @brief   Returns how many times an error of one type has occurred since start-up
+  *
+  * @param   driverError: Error type to read
+  *
+  * @retval  uint32_t: Error count, or 0 for an unknown type
+  */
+template<typename ENCODER_TRAITS>
+uint32_t SPIEncoder<ENCODER_TRAITS>::getErrorCount(EncoderDriverError_t driverError)
+{
+  if (driverError >= NUMBER_OF_ENCODER_DRIVER_ERRORS)
+  {
+    return (0U);
+  }
+
+  return (_errorCounts[driverError]);
+}
+
+
+/**
+  * @brief   Returns the encoder's health state, the failures in its current window and
+  *          how often it has been quarantined and fetches skipped
+  *
+  * @param   None
+  *
+  * @retval  DeviceHealthReport_t: Health report for this encoder
+  */
+template<typename ENCODER_TRAITS>
+DeviceHealthReport_t SPIEncoder<ENCODER_TRAITS>::getHealth(void)
+{
+  return (_health.getReport());
+}
+
+
+/**
+  * @brief   Sets when the encoder is quarantined, how often it is probed and when it is
+  *          restored (see DeviceHealthConfig_t), restoring it to healthy
+  *
+  * @warning Call while no fetch is in flight - the health window is updated from the SPI ISR
+  *
+  * @param   healthConfig: Quarantine policy
+  *
+  * @retval  status_t: STATUS_ERROR if the policy is out of range
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::setHealthPolicy(DeviceHealthConfig_t healthConfig)
+{
+  return (_health.configure(healthConfig));
+}
+
+
+/**
+  * @brief   Starts continuous position streaming on a bus dedicated to this encoder
+  *
+  * @warning The trigger timer must be configured to drive the encoder chip select and
+  *          pace the SPI tx DMA. The CPU is then only involved on half/full ring events.
+  *
+  * @param   triggerTimer:   Timer handle pacing the stream frames
+  *
+  * @param   triggerChannel: Timer channel driving the encoder chip select
+  *
+  * @retval  status_t: STATUS_ERROR if the bus is busy or could not be configured
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::startPositionStream(TIM_HandleTypeDef* triggerTimer, uint32_t triggerChannel)
+{
+  SPIStream_t positionSPIStream = { .SPIObject      = SPI::getObjectContext(),
+                                    .SPIBusID       = _SPIBusID,
+                                    .triggerTimer   = triggerTimer,
+                                    .triggerChannel = triggerChannel,
+                                    .txBuffer       = _streamTxBuffer,
+                                    .rxBuffer       = _streamRxBuffer,
+                                    .frameLength    = ENCODER_FRAME_SIZE_IN_BYTES,
+                                    .frameCount     = ENCODER_STREAM_SLOT_COUNT
+                                  };
+
+  _hasFetched = true;
+
+  return (SPI::startStream(positionSPIStream));
+}
+
+
+/**
+  * @brief   Stops continuous position streaming and returns the bus to job mode
+  *
+  * @param   None
+  *
+  * @retval  status_t: STATUS_ERROR if no stream was running
+  */
+template<typename ENCODER_TRAITS>
+status_t SPIEncoder<ENCODER_TRAITS>::stopPositionStream(void)
+{
+  return (SPI::stopStream(_SPIBusID));
+}
+
+
+/**
+  * @brief   Decodes the most recently completed stream frame on demand
+  *
+  * @warning Falls back to the last valid position if the newest frame fails its checks, or
+  *          if this encoder is not streaming. Error counts are left to the batch processing
+  *          so frames are not counted twice.
+  *
+  * @param   None
+  *
+  * @retval  uint16_t: Newest encoder position available in the stream ring
+  */
+template<typename ENCODER_TRAITS>
+uint16_t SPIEncoder<ENCODER_TRAITS>::getLatestStreamPosition(void)
+{
+  EncoderPayload_t positionPayload = {0U, 0U};
+
+  uint16_t latestSlot = SPI::getLatestStreamFrameIndex(_SPIBusID);
+
+  if (latestSlot >= ENCODER_STREAM_SLOT_COUNT)
+  {
+    return (_lastValidPosition);
+  }
+
+  if ((decodePacket(getStreamSlot(latestSlot), &positionPayload) == STATUS_OK) &&
+      (positionPayload.status == ENCODER_TRAITS::STATUS_OK)                     )
+  {
+    return (_linearityTable.apply(positionPayload.position));
+  }
+
+  return (_lastValidPosition);
+}
+
+/*************************************************************************************/
+/* CALLBACK HANDLERS                                                                 */
+/*************************************************************************************/
+
+/**
+  * @brief   Callback from SPI base class called when a transaction is completed successfully
+  *
+  * @param   None
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::transmitReceiveComplete(void)
+{
+  recordSampleTiming(SPI::getTransferTimestamp());
+
+  if (_deferredDecode)
+  {
+    publishRawFrame(false, FrameLayout_t::toWord(_positionRxPacket.asBytes), SPI::getTransferTimestamp());
+
+    positionFetchComplete(STATUS_OK);
+    _fetchWaiter.complete(STATUS_OK);
+    return;
+  }
+
+  status_t receiveStatus = processReceivedPacket(_positionRxPacket, SPI::getTransferTimestamp());
+
+  recordFetchHealth(receiveStatus == STATUS_OK);
+
+  positionFetchComplete(receiveStatus);
+  _fetchWaiter.complete(receiveStatus);
+}
+
+
+/**
+  * @brief   Callback from SPI base class called when a transaction has failed
+  *
+  * @param   None
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::transferError(void)
+{
+  incrementErrorCount(ENCODER_DRIVER_ERROR_SPI_TRANSFER);
+  recordSampleTiming(SPI::getTransferTimestamp());
+
+  /* Telemetry and health are written from one context only - the reader's, in deferred mode */
+  if (_deferredDecode)
+  {
+    publishRawFrame(true, 0U, SPI::getTransferTimestamp());
+  }
+  else
+  {
+    publishSample(ENCODER_SAMPLE_TRANSFER_ERROR, SPI::getTransferTimestamp());
+    recordFetchHealth(false);
+  }
+
+  _fetchWaiter.complete(STATUS_ERROR);
+}
+
+
+/**
+  * @brief   Callback from SPI base class called when the first half of the stream ring is filled
+  *
+  * @param   None
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::streamHalfComplete(void)
+{
+  status_t batchStatus = processStreamSlots(0U, ENCODER_STREAM_SLOT_COUNT / 2U);
+
+  positionFetchComplete(batchStatus);
+}
+
+
+/**
+  * @brief   Callback from SPI base class called when the second half of the stream ring is filled
+  *
+  * @param   None
+  *
+  * @retval  None
+  */
+template<typename ENCODER_TRAITS>
+void SPIEncoder<ENCODER_TRAITS>::streamComplete(void)
+{
+  status_t batchStatus = processStreamSlots(ENCODER_STREAM_SLOT_COUNT / 2U, ENCODER_STREAM_SLOT_COUNT / 2U);
+
+  positionFetchComplete(batchStatus);
+}
+
+
+/*************************************************************************************/
+/* VARIANT INSTANTIATIONS                                                            */
+/*************************************************************************************/
+
+template class SPIEncoder<RLSOrbis14BitTraits>;
+template class SPIEncoder<RLSOrbis13BitTraits>;
+template class SPIEncoder<RLSOrbis12BitTraits>;
 
 
 /**
@@ -5,7 +5,9 @@
   * @author  D. Baines
   *
   * @brief   File contains defines, type declarations, and function prototypes
-  *          for interfacing with an RLS Orbis SPI encoder.
+  *          for interfacing with an SPI absolute encoder such as the RLS Orbis.
+  *          The driver is templated on a traits type describing the variant's
+  *          frame (see encoderTraits.hpp); Encoder is the 14-bit Orbis.
   *
   * @version v1.0
   ******************************************************************************
@@ -31,130 +33,370 @@
 
 #include "gpio.h"
 #include "../PeripheralLayer/STM32-SPIBus.hpp"
+#include "../PeripheralLayer/SPITopology.hpp"
+#include "../Utilities/coroutineTask.hpp"
 #include "../Utilities/CRC8.hpp"
+#include "../Utilities/deviceHealth.hpp"
+#include "../Utilities/fixedPointTrig.hpp"
+#include "../Utilities/linearityTable.hpp"
+#include "../Utilities/positionFilter.hpp"
+#include "../Utilities/telemetryEncoder.hpp"
+#include "../Utilities/timingStatistics.hpp"
 #include "../Utilities/utilities.hpp"
+#include "encoderPositionTable.hpp"
+#include "encoderTraits.hpp"
 
 
 /*************************************************************************************/
 /* CLASS DEFINITIONS                                                                 */
 /*************************************************************************************/
 
-class Encoder:
-private SPI,
-private CRC8
+/* Variants are instantiated in encoder.cpp - add a line there for each new traits type */
+template<typename ENCODER_TRAITS>
+class SPIEncoder:
+private SPI
 {
 
   public:
 
   /*-- Public Variables -------------------------------------------------------------*/
 
+  typedef struct
+  {
+    uint16_t position;
+    bool     valid;
+
+  } PositionEstimate_t;
+
+
+  typedef struct
+  {
+    uint32_t frameCount;
+    uint32_t validCount;
+    uint32_t CRCFailCount;
+    uint32_t statusErrorCount;
+    uint32_t cycles;
+
+  } ReplayStatistics_t;
+
+
+  typedef struct
+  {
+    TimingSummary_t sampleInterval;
+    TimingSummary_t fetchLatency;
+    uint32_t        droppedLatencyCount;
+
+  } SampleTimingReport_t;
+
+
+  typedef enum: uint8_t
+  {
+    ENCODER_DRIVER_ERROR_CRC_FAIL     = 0,
+    ENCODER_DRIVER_ERROR_SPI_BAD_JOB  = 1,
+    ENCODER_DRIVER_ERROR_SPI_TRANSFER = 2,
+    ENCODER_DRIVER_ERROR_STATUS       = 3,
+    NUMBER_OF_ENCODER_DRIVER_ERRORS
+  } EncoderDriverError_t;
+
+
+  /* co_await from a Task - yields the fetch status_t once the sample has been processed */
+  class PositionFetchAwaiter
+  {
+    public:
+
+    PositionFetchAwaiter(SPIEncoder* encoder) : _encoder(encoder) {}
+
+    bool await_ready(void)
+    {
+      return (false);
+    }
+
+    bool await_suspend(Task::handle_t handle)
+    {
+      _started = (_encoder->startAwaitedFetch(handle) == STATUS_OK);
+
+      return (_started);
+    }
+
+    status_t await_resume(void)
+    {
+      return (_started ? _encoder->_fetchWaiter.getStatus() : STATUS_ERROR);
+    }
+
+    private:
+
+    SPIEncoder* _encoder;
+    bool        _started = false;
+  };
+
 
   /*-- Public Prototypes ------------------------------------------------------------*/
 
-  Encoder(GPIO_TypeDef*  chipSelectPort,
-          uint16_t       chipSelectPin,
-          SPIBusID_t     SPIBusID);
+  SPIEncoder(GPIO_TypeDef*  chipSelectPort,
+             uint16_t       chipSelectPin,
+             SPIBusID_t     SPIBusID);
+
+  SPIEncoder(GPIO_TypeDef*       chipSelectPort,
+             uint16_t            chipSelectPin,
+             SPIBusID_t          SPIBusID,
+             SPI::SPIBusConfig_t busConfig);
+
+  /* Built from its SPI_DEVICE_TOPOLOGY entry, so a constinit encoder needs no startup code
+   * and its chip select and settings have been through the topology checks */
+  constexpr SPIEncoder(SPIDeviceID_t deviceID) : SPIEncoder(SPI_DEVICE_TOPOLOGY[deviceID]) {}
 
-  virtual ~Encoder() {};
+  virtual ~SPIEncoder() {};
 
   void triggerPositionFetch(void);
 
+  PositionFetchAwaiter fetchPosition(void);
+
   uint16_t getLastValidPosition(void);
 
+  uint16_t getLastRawPosition(void);
 
-  private:
+  PositionEstimate_t getPositionAt(uint32_t timestamp);
 
-  /*-- Private Constants ------------------------------------------------------------*/
+  void setPredictionHorizon(uint32_t horizonCycles);
 
-  static const uint8_t ORBIS_CRC_POLYNOMIAL                = 0x97U;
+  void setDeferredDecode(bool deferredDecode);
 
-  static const uint8_t ORBIS_POSITION_PACKET_SIZE_IN_BYTES = 3U;
-  static const uint8_t ORBIS_CRC_SIZE_IN_BYTES             = 1U;
+  uint32_t getLastSampleTimestamp(void);
 
-  static const uint8_t ORBIS_POSITION_DATA_RESOLUTION      = 14U;
-  static const uint8_t ORBIS_STATUS_BIT_SIZE               = 2U;
+  SampleTimingReport_t getSampleTiming(void);
 
-  /*-- Private Typedefs -------------------------------------------------------------*/
+  void resetSampleTiming(uint32_t histogramBinWidth);
 
-  typedef enum: uint8_t
+  ReplayStatistics_t replayCapture(const uint8_t* captureDump, uint32_t length, uint8_t deviceID);
+
+  status_t startPositionStream(TIM_HandleTypeDef* triggerTimer, uint32_t triggerChannel);
+
+  status_t stopPositionStream(void);
+
+  uint16_t getLatestStreamPosition(void);
+
+  void attachPositionTable(EncoderTableSlot_t tableSlot);
+
+  void attachTelemetry(TelemetryEncoder* telemetry);
+
+  void attachPositionFilter(PositionFilter* positionFilter);
+
+  uint32_t getFilterWorstCaseCycles(void);
+
+  status_t loadLinearityCalibration(const uint8_t* calibrationBlob, uint32_t length);
+
+  void setElectricalAngleOffset(uint16_t electricalAngleOffset);
+
+  uint32_t getErrorCount(EncoderDriverError_t driverError);
+
+  DeviceHealthReport_t getHealth(void);
+
+  status_t setHealthPolicy(DeviceHealthConfig_t healthConfig);
+
+  /* Commutation kernels are templated on pole pairs so the multiply folds to shifts/constants */
+  template<uint8_t POLE_PAIRS>
+  uint16_t getElectricalAngle(void)
   {
-    ORBIS_STATUS_OK                = 0b11,
-    ORBIS_STATUS_ERROR             = 0b01,
-    ORBIS_STATUS_WARNING           = 0b10,
-    ORBIS_STATUS_ERROR_AND_WARNING = 0b00,
+    static_assert(POLE_PAIRS > 0U, "Motor must have at least one pole pair");
 
-  } OrbisStatus_t;
+    /* Scale the mechanical position to a 16-bit turn - the electrical angle then wraps for free in uint16_t */
+    uint16_t mechanicalAngle = static_cast<uint16_t>(getLastValidPosition() << (ANGLE_RESOLUTION_BITS - ENCODER_POSITION_RESOLUTION));
 
-  typedef union
+    return (static_cast<uint16_t>((mechanicalAngle * POLE_PAIRS) - _electricalAngleOffset));
+  }
+
+  template<uint8_t POLE_PAIRS>
+  SinCosQ15_t getCommutationQ15(void)
   {
-    uint16_t asUINT16;
+    return (sinCosQ15(getElectricalAngle<POLE_PAIRS>()));
+  }
 
-    struct
-    {
-      unsigned status   : ORBIS_STATUS_BIT_SIZE;
-      unsigned position : ORBIS_POSITION_DATA_RESOLUTION;
+  template<uint8_t POLE_PAIRS>
+  SinCosQ31_t getCommutationQ31(void)
+  {
+    return (sinCosQ31(getElectricalAngle<POLE_PAIRS>()));
+  }
 
-    } asData;
 
-  } OrbisPositionPayload_t;
+  protected:
 
+  /*-- Protected Prototypes ---------------------------------------------------------*/
 
-  typedef union
+  /* For devices outside the topology table, such as the host replay tools - unchecked */
+  constexpr SPIEncoder(const SPIDeviceDescriptor_t& device):
+  SPI(device.hasBusConfig, device.busConfig), _chipSelectPortAddress(device.csPortAddress),
+  _chipSelectPin(device.csPin), _SPIBusID(device.SPIBusID), _sampleIntervalTiming(ENCODER_DEFAULT_TIMING_BIN_WIDTH),
+  _fetchLatencyTiming(ENCODER_DEFAULT_TIMING_BIN_WIDTH), _linearityTable(ENCODER_POSITION_RESOLUTION)
+  {}
+
+
+  private:
+
+  /*-- Private Constants ------------------------------------------------------------*/
+
+  typedef EncoderFrameLayout<ENCODER_TRAITS> FrameLayout_t;
+
+  static const uint8_t ENCODER_FRAME_SIZE_IN_BYTES         = ENCODER_TRAITS::FRAME_SIZE_IN_BYTES;
+  static const uint8_t ENCODER_POSITION_RESOLUTION         = ENCODER_TRAITS::POSITION_BITS;
+
+  static const uint8_t ENCODER_STREAM_SLOT_COUNT           = 8U;
+
+  /* A deferred read retried this often without a quiet window is left for the next read */
+  static const uint8_t ENCODER_RAW_FRAME_READ_ATTEMPTS     = 4U;
+
+  /* 1 ms at the F4's 168 MHz core clock */
+  static const uint32_t ENCODER_DEFAULT_PREDICTION_HORIZON = 168000U;
+  static const uint32_t ENCODER_DEFAULT_TIMING_BIN_WIDTH   = 168U;
+
+  /* 100 ms - anything longer is a lost trigger, and would swamp the latency sum of squares */
+  static const uint32_t ENCODER_MAX_FETCH_LATENCY          = 16800000U;
+
+  /* Table is built by the compiler - one per variant, in flash */
+  static constexpr CRC8 ENCODER_CRC                        = CRC8(ENCODER_TRAITS::CRC_POLYNOMIAL);
+
+  /*-- Private Typedefs -------------------------------------------------------------*/
+
+  typedef struct
   {
-    uint8_t asBytes[ORBIS_POSITION_PACKET_SIZE_IN_BYTES];
+    uint16_t position;
+    uint8_t  status;
 
-    struct
-    {
-      uint16_t positionPayload;
-      uint8_t  OrbisCRC;
+  } EncoderPayload_t;
 
-    } asData;
 
-  } OrbisPositionReceivePacket_t;
+  typedef struct
+  {
+    uint8_t asBytes[ENCODER_FRAME_SIZE_IN_BYTES];
 
+  } EncoderFrame_t;
 
-  typedef enum: uint8_t
+
+  typedef struct
   {
-    ORBIS_DRIVER_ERROR_CRC_FAIL     = 0,
-    ORBIS_DRIVER_ERROR_SPI_BAD_JOB  = 1,
-    ORBIS_DRIVER_ERROR_SPI_TRANSFER = 2,
-    ORBIS_DRIVER_ERROR_STATUS       = 3,
-    NUMBER_OF_ORBIS_DRIVER_ERRORS
-  } OrbisDriverError_t;
+    uint16_t position;
+    uint32_t timestamp;
+
+  } EncoderSample_t;
 
 
   /*-- Private Variables ------------------------------------------------------------*/
 
-  GPIO_TypeDef                *_chipSelectPort;
+  /* Held as an address so the encoder can be built in a constant expression - see getChipSelectPort() */
+  uintptr_t                    _chipSelectPortAddress;
   uint16_t                     _chipSelectPin;
   SPIBusID_t                   _SPIBusID;
 
-  volatile uint16_t            _lastValidPosition;
-  volatile OrbisStatus_t       _orbisStatus;
+  volatile uint16_t            _lastValidPosition     = 0U;
+  volatile uint16_t            _lastRawPosition       = 0U;
+  volatile uint8_t             _encoderStatus         = 0U;
+
+  uint16_t                     _electricalAngleOffset = 0U;
+
+  EncoderSample_t              _latestSample          = {0U, 0U};
+  EncoderSample_t              _previousSample        = {0U, 0U};
+  uint8_t                      _validSampleCount      = 0U;
+  uint32_t                     _predictionHorizon     = ENCODER_DEFAULT_PREDICTION_HORIZON;
+  uint32_t                     _lastStreamEventTime   = 0U;
+
+  /* Set by the first fetch or stream - a live encoder refuses capture replay */
+  bool                         _hasFetched            = false;
+
+  EncoderTableSlot_t           _tableSlot             = {NULL, NULL, NULL, NULL, 0U};
+  TelemetryEncoder*            _telemetry             = NULL;
+
+  PositionFilter*              _positionFilter        = NULL;
+  uint32_t                     _filterWorstCaseCycles = 0U;
 
-  uint8_t                      _positionTxBuffer[ORBIS_POSITION_PACKET_SIZE_IN_BYTES] = {0U};
-  OrbisPositionReceivePacket_t _positionRxPacket;
+  /* Task suspended in fetchPosition(), resumed by the next fetch completion */
+  AwaitingCoroutine            _fetchWaiter;
 
-  uint32_t                     _errorCounts[NUMBER_OF_ORBIS_DRIVER_ERRORS] = {0U};
+  /* Chip select edge timing - interval between consecutive samples and delay from trigger to sample */
+  TimingStatistics             _sampleIntervalTiming;
+  TimingStatistics             _fetchLatencyTiming;
+  uint32_t                     _droppedLatencyCount   = 0U;
+  volatile uint32_t            _lastSampleTimestamp   = 0U;
+  bool                         _hasSampleTimestamp    = false;
+
+  /* Deferred decode - the ISR only publishes the raw frame, or a failed transfer, written before its sequence number */
+  bool                         _deferredDecode        = false;
+  volatile bool                _rawTransferFailed     = false;
+  volatile uint32_t            _rawFrame              = 0U;
+  volatile uint32_t            _rawTimestamp          = 0U;
+  volatile uint32_t            _rawSequence           = 0U;
+  uint32_t                     _decodedSequence       = 0U;
+
+  LinearityTable               _linearityTable;
+
+  uint8_t                      _positionTxBuffer[ENCODER_FRAME_SIZE_IN_BYTES] = {0U};
+  EncoderFrame_t               _positionRxPacket      = {{0U}};
+
+  uint32_t                     _errorCounts[NUMBER_OF_ENCODER_DRIVER_ERRORS] = {0U};
+
+  /* Outcome of every triggered fetch - a failing encoder is dropped to probe fetches to free its bus slots */
+  DeviceHealthTracker          _health                = DeviceHealthTracker(DEVICE_HEALTH_DEFAULT_CONFIG);
+
+  /* Stream slots are raw bytes - the DMA writes frames back-to-back */
+  uint8_t                      _streamRxBuffer[ENCODER_STREAM_SLOT_COUNT * ENCODER_FRAME_SIZE_IN_BYTES] = {0U};
+
+  static uint8_t               _streamTxBuffer[ENCODER_STREAM_SLOT_COUNT * ENCODER_FRAME_SIZE_IN_BYTES];
 
   /*-- Private Prototypes -----------------------------------------------------------*/
 
-  void incrementErrorCount(OrbisDriverError_t driverError);
+  GPIO_TypeDef* getChipSelectPort(void);
+
+  void incrementErrorCount(EncoderDriverError_t driverError);
+
+  void recordFetchHealth(bool fetchSucceeded);
+
+  uint16_t filterPosition(uint16_t rawPosition);
+
+  status_t queuePositionFetch(void);
+
+  status_t startAwaitedFetch(Task::handle_t handle);
+
+  void publishSample(EncoderSampleStatus_t sampleStatus, uint32_t sampleTimestamp);
 
-  status_t processReceivedPacket(OrbisPositionReceivePacket_t packetIn);
+  status_t decodePacket(EncoderFrame_t packetIn, EncoderPayload_t* payloadOut);
+
+  EncoderFrame_t getStreamSlot(uint8_t slot);
+
+  status_t processReceivedPacket(EncoderFrame_t packetIn, uint32_t sampleTimestamp);
+
+  status_t processStreamSlots(uint8_t firstSlot, uint8_t slotCount);
+
+  void publishRawFrame(bool transferFailed, uint32_t rawFrame, uint32_t rawTimestamp);
+
+  void decodeDeferredFrame(void);
+
+  void recordSampleTiming(uint32_t sampleTimestamp);
+
+  int16_t wrappedPositionStep(uint16_t fromPosition, uint16_t toPosition);
 
   /* Callback to derived class to signal complete position data collection */
   virtual void positionFetchComplete(status_t positionFetchStatus) = 0;
 
+  /* Callback to derived class to signal the encoder has been quarantined or restored - optional, called from the SPI ISR,
+   * or from the reader's context in deferred decode */
+  virtual void healthChanged(DeviceHealthState_t healthState) { (void)healthState; };
+
   /* Callback from SPI base class to signal complete data transaction */
   virtual void transmitReceiveComplete(void) final;
 
   /* Callback from SPI base class to signal data transaction error */
   virtual void transferError(void) final;
 
+  /* Callback from SPI base class to signal the first half of the stream slots has been filled */
+  virtual void streamHalfComplete(void) final;
+
+  /* Callback from SPI base class to signal the second half of the stream slots has been filled */
+  virtual void streamComplete(void) final;
+
 };
 
 
+typedef SPIEncoder<RLSOrbis14BitTraits> Encoder;
+
+
 #endif /* __RLSOrbis_H */
 
 /**
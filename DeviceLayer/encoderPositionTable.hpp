@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file    encoderPositionTable.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains type declarations and the template implementation
+  *          of a contiguous struct-of-arrays table of encoder samples, for
+  *          controllers which read many axes every control cycle.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __encoderPositionTable_H
+#define __encoderPositionTable_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include "../Utilities/utilities.hpp"
+
+/*************************************************************************************/
+/* MODULE CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/* Covers a host cache line as well as the Cortex-M7 line, so a block never straddles more lines than needed */
+const uint8_t ENCODER_TABLE_ALIGNMENT     = 64U;
+
+/* A copy retried this often without a quiet window is given up - the reader has preempted a writer */
+const uint8_t ENCODER_TABLE_COPY_ATTEMPTS = 4U;
+
+/*************************************************************************************/
+/* TYPEDEFS                                                                          */
+/*************************************************************************************/
+
+typedef enum: uint8_t
+{
+  ENCODER_SAMPLE_NONE           = 0U,
+  ENCODER_SAMPLE_OK             = 1U,
+  ENCODER_SAMPLE_STATUS_ERROR   = 2U,
+  ENCODER_SAMPLE_CRC_FAIL       = 3U,
+  ENCODER_SAMPLE_TRANSFER_ERROR = 4U,
+} EncoderSampleStatus_t;
+
+
+/* Where a registered encoder publishes its samples - one entry in each of the table's arrays,
+ * and the table's sequence counter, which every write moves odd while it is under way */
+typedef struct
+{
+  volatile uint16_t* position;
+  volatile uint8_t*  status;
+  volatile uint32_t* timestamp;
+  volatile uint32_t* sequence;
+  uint32_t           writePriority;
+
+} EncoderTableSlot_t;
+
+/*************************************************************************************/
+/* INLINE FUNCTIONS                                                                  */
+/*************************************************************************************/
+
+/* Publishes one sample - the position and timestamp only for a valid one. Writers mask each other
+ * up to the table's write priority, so the sequence is only ever odd for one write at a time */
+static inline void PUBLISH_TABLE_SAMPLE(const EncoderTableSlot_t& slot, EncoderSampleStatus_t status, uint16_t position, uint32_t timestamp)
+{
+  uint32_t basepri = ENTER_PRIORITY_CRITICAL_SECTION(slot.writePriority);
+
+  *slot.sequence = *slot.sequence + 1U;
+  __DMB();
+
+  if (status == ENCODER_SAMPLE_OK)
+  {
+    *slot.position  = position;
+    *slot.timestamp = timestamp;
+  }
+
+  *slot.status = status;
+
+  __DMB();
+  *slot.sequence = *slot.sequence + 1U;
+
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+}
+
+/*************************************************************************************/
+/* TEMPLATE IMPLEMENTATIONS                                                          */
+/*************************************************************************************/
+
+template<uint8_t ENCODER_COUNT>
+class EncoderPositionTable
+{
+  public:
+
+  /* Public Variables ---------------------------------------------------------------*/
+
+  /* Position/timestamp of the last valid sample, and the status of the latest sample, per registered encoder */
+  typedef struct alignas(ENCODER_TABLE_ALIGNMENT)
+  {
+    uint16_t position[ENCODER_COUNT];
+    uint8_t  status[ENCODER_COUNT];
+    uint32_t timestamp[ENCODER_COUNT];
+
+  } Block_t;
+
+
+  /* Public Prototypes --------------------------------------------------------------*/
+
+  /* writePriority is the highest (numerically lowest) NVIC priority of any context publishing
+   * into the table - the highest bus priority among its encoders */
+  EncoderPositionTable(uint32_t writePriority) : _writePriority(writePriority) {}
+
+
+  EncoderTableSlot_t getSlot(uint8_t index)
+  {
+    EncoderTableSlot_t slot = { .position      = NULL,
+                                .status        = NULL,
+                                .timestamp     = NULL,
+                                .sequence      = NULL,
+                                .writePriority = _writePriority
+                              };
+
+    if (index < ENCODER_COUNT)
+    {
+      slot.position  = &_block.position[index];
+      slot.status    = &_block.status[index];
+      slot.timestamp = &_block.timestamp[index];
+      slot.sequence  = &_sequence;
+    }
+
+    return (slot);
+  }
+
+
+  /* Read in place - entries are naturally aligned so each is written atomically, but a
+   * position and its timestamp may be one sample apart if a write lands mid-read. Use
+   * copyOut() where they must match */
+  const volatile Block_t& getBlock(void)
+  {
+    return (_block);
+  }
+
+
+  /**
+    * @brief  Takes a consistent copy of the whole table, retrying while writes land mid-copy
+    *
+    * @param  destination: Copy of the table
+    *
+    * @retval bool: False if no quiet window was found - the caller has preempted a writer,
+    *               and should keep its previous copy
+    */
+  bool copyOut(Block_t* destination)
+  {
+    for (uint8_t attempt = 0U; attempt < ENCODER_TABLE_COPY_ATTEMPTS; attempt++)
+    {
+      uint32_t sequence = _sequence;
+
+      /* Odd while a write is under way */
+      if ((sequence & 1U) != 0U)
+      {
+        continue;
+      }
+
+      __DMB();
+
+      for (uint8_t encoder = 0U; encoder < ENCODER_COUNT; encoder++)
+      {
+        destination->position[encoder]  = _block.position[encoder];
+        destination->status[encoder]    = _block.status[encoder];
+        destination->timestamp[encoder] = _block.timestamp[encoder];
+      }
+
+      __DMB();
+
+      if (sequence == _sequence)
+      {
+        return (true);
+      }
+    }
+
+    return (false);
+  }
+
+
+  private:
+
+  /* Private Variables --------------------------------------------------------------*/
+
+  volatile Block_t  _block         = {};
+  volatile uint32_t _sequence      = 0U;
+  uint32_t          _writePriority;
+
+};
+
+
+#endif /* __encoderPositionTable_H */
+
+/**
+  * @}End of File
+  */
+
+
@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    encoderTraits.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the traits types describing each supported SPI
+  *          encoder variant's frame, and the compile-time frame decoder built
+  *          from them.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __encoderTraits_H
+#define __encoderTraits_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* ENCODER TRAITS                                                                    */
+/*************************************************************************************/
+
+/*
+ * A traits type describes one encoder variant's position read frame:
+ *
+ *   FRAME_SIZE_IN_BYTES  bytes clocked per position read, at most 4
+ *   POSITION_OFFSET/BITS position field, at most 16 bits
+ *   STATUS_OFFSET/BITS   status field, at most 8 bits, equal to STATUS_OK when healthy
+ *   CRC_BYTE_INDEX       CRC-8 byte, computed over every byte before it
+ *   CRC_POLYNOMIAL       CRC-8 generator, MSB first
+ *   CRC_INITIAL_VALUE    CRC register value before the first byte
+ *   CRC_FINAL_XOR        value XORed into the CRC before it is sent
+ *
+ * Bit offsets count from the most significant bit of the first byte on the wire. The
+ * driver clocks out zeros during position reads, so the device must ignore MOSI then.
+ */
+
+/* RLS Orbis - lower resolutions are left aligned in the 14-bit position field */
+template<uint8_t RESOLUTION>
+struct RLSOrbisTraits
+{
+  static_assert((RESOLUTION > 0U) && (RESOLUTION <= 14U), "Orbis position field holds at most 14 bits");
+
+  static const uint8_t FRAME_SIZE_IN_BYTES = 3U;
+
+  static const uint8_t POSITION_OFFSET     = 0U;
+  static const uint8_t POSITION_BITS       = RESOLUTION;
+
+  /* Error bit then warning bit, both active low */
+  static const uint8_t STATUS_OFFSET       = 14U;
+  static const uint8_t STATUS_BITS         = 2U;
+  static const uint8_t STATUS_OK           = 0b11U;
+
+  static const uint8_t CRC_BYTE_INDEX      = 2U;
+  static const uint8_t CRC_POLYNOMIAL      = 0x97U;
+  static const uint8_t CRC_INITIAL_VALUE   = 0x00U;
+  static const uint8_t CRC_FINAL_XOR       = 0xFFU;
+};
+
+typedef RLSOrbisTraits<14U> RLSOrbis14BitTraits;
+typedef RLSOrbisTraits<13U> RLSOrbis13BitTraits;
+typedef RLSOrbisTraits<12U> RLSOrbis12BitTraits;
+
+/*************************************************************************************/
+/* FRAME DECODER                                                                     */
+/*************************************************************************************/
+
+/* Fields are pulled out of the frame as one big-endian word, so every variant decodes
+ * with constant shifts and masks and no branches */
+template<typename ENCODER_TRAITS>
+struct EncoderFrameLayout
+{
+  static const uint8_t FRAME_BITS = ENCODER_TRAITS::FRAME_SIZE_IN_BYTES * 8U;
+
+  static_assert((ENCODER_TRAITS::FRAME_SIZE_IN_BYTES > 0U) && (ENCODER_TRAITS::FRAME_SIZE_IN_BYTES <= 4U),
+                "Frame must fit a 32-bit word");
+  static_assert((ENCODER_TRAITS::POSITION_BITS > 0U) && (ENCODER_TRAITS::POSITION_BITS <= 16U),
+                "Position must fit 16 bits");
+  static_assert((ENCODER_TRAITS::STATUS_BITS > 0U) && (ENCODER_TRAITS::STATUS_BITS <= 8U),
+                "Status must fit 8 bits");
+  static_assert(ENCODER_TRAITS::CRC_BYTE_INDEX < ENCODER_TRAITS::FRAME_SIZE_IN_BYTES,
+                "CRC byte must lie inside the frame");
+  static_assert((ENCODER_TRAITS::POSITION_OFFSET + ENCODER_TRAITS::POSITION_BITS) <= (ENCODER_TRAITS::CRC_BYTE_INDEX * 8U),
+                "Position field must lie inside the CRC protected bytes");
+  static_assert((ENCODER_TRAITS::STATUS_OFFSET + ENCODER_TRAITS::STATUS_BITS) <= (ENCODER_TRAITS::CRC_BYTE_INDEX * 8U),
+                "Status field must lie inside the CRC protected bytes");
+
+  static constexpr uint32_t toWord(const uint8_t* frame)
+  {
+    uint32_t word = 0U;
+
+    for (uint8_t byte = 0U; byte < ENCODER_TRAITS::FRAME_SIZE_IN_BYTES; byte++)
+    {
+      word = (word << 8U) | frame[byte];
+    }
+
+    return (word);
+  }
+
+  template<uint8_t OFFSET, uint8_t BITS>
+  static constexpr uint32_t field(uint32_t word)
+  {
+    return ((word >> (FRAME_BITS - OFFSET - BITS)) & ((1UL << BITS) - 1U));
+  }
+
+  static constexpr uint16_t position(uint32_t word)
+  {
+    return (static_cast<uint16_t>(field<ENCODER_TRAITS::POSITION_OFFSET, ENCODER_TRAITS::POSITION_BITS>(word)));
+  }
+
+  static constexpr uint8_t status(uint32_t word)
+  {
+    return (static_cast<uint8_t>(field<ENCODER_TRAITS::STATUS_OFFSET, ENCODER_TRAITS::STATUS_BITS>(word)));
+  }
+
+  static constexpr uint8_t CRC(uint32_t word)
+  {
+    return (static_cast<uint8_t>(field<ENCODER_TRAITS::CRC_BYTE_INDEX * 8U, 8U>(word)));
+  }
+};
+
+
+#endif /* __encoderTraits_H */
+
+/**
+  * @}End of File
+  */
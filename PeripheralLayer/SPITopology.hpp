@@ -0,0 +1,237 @@
+/**
+  ******************************************************************************
+  * @file    SPITopology.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the compile-time description of the SPI buses and
+  *          the devices on them, and the constexpr checks run over it. Buses
+  *          and devices built from these tables are constant-initialised, so
+  *          no driver constructor runs before main.
+  *
+  *          Every device is listed once in SPI_DEVICE_TOPOLOGY, which the checks
+  *          at the end of this file run over, and is built from its ID:
+  *
+  *            constinit AxisEncoder axis1(SPI_DEVICE_ENCODER_1);
+  *
+  *          Adding a device means adding its SPIDeviceID_t and its table entry.
+  *          The device class's own constructor must be constexpr for constinit to hold.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __SPITopology_H
+#define __SPITopology_H
+
+/**************************************************************************************
+ * INCLUDES
+ *************************************************************************************/
+
+#include <stddef.h>
+#include "spi.h"
+#include "STM32-SPIBus.hpp"
+
+
+/**************************************************************************************
+ * TYPEDEFS
+ *************************************************************************************/
+
+/* One device on a bus. The chip select port is held as its base address (GPIOx_BASE)
+ * since the GPIOx pointer macros are casts, which cannot appear in a constant expression.
+ * Devices without their own settings leave out the bus config */
+typedef struct
+{
+  SPIBusID_t          SPIBusID;
+  uintptr_t           csPortAddress;
+  uint16_t            csPin;
+  bool                hasBusConfig = false;
+  SPI::SPIBusConfig_t busConfig    = {0U, 0U, 0U, 0U};
+
+} SPIDeviceDescriptor_t;
+
+
+/* Indexes SPI_DEVICE_TOPOLOGY */
+typedef enum: uint8_t
+{
+  SPI_DEVICE_ENCODER_1 = 0,
+  NUMBER_OF_SPI_DEVICES
+} SPIDeviceID_t;
+
+
+/**************************************************************************************
+ * BUS TOPOLOGY
+ *************************************************************************************/
+
+/* Indexed by SPIBusID_t - IRQ priorities must match the NVIC priorities given to each SPI and its DMA streams in CubeMX */
+constexpr SPIBusDescriptor_t SPI_BUS_TOPOLOGY[] = {
+                                                    { .SPIBusID = SPI_BUS_1, .spiHandle = &hspi1, .IRQPriority = 5U }
+                                                  };
+
+
+/**************************************************************************************
+ * DEVICE TOPOLOGY
+ *************************************************************************************/
+
+/* Indexed by SPIDeviceID_t - every device on every bus, with its chip select and any settings of its own */
+constexpr SPIDeviceDescriptor_t SPI_DEVICE_TOPOLOGY[] = {
+                                                          { .SPIBusID = SPI_BUS_1, .csPortAddress = GPIOA_BASE, .csPin = GPIO_PIN_4 }
+                                                        };
+
+
+/**************************************************************************************
+ * TOPOLOGY CHECKS
+ *************************************************************************************/
+
+/* Every bus has exactly one entry, in SPIBusID_t order, with a priority BASEPRI can mask (not 0). Handles
+ * are not compared against NULL - that is not a constant expression under -fno-delete-null-pointer-checks */
+template<size_t BUS_COUNT>
+constexpr bool SPIBusTopologyIsValid(const SPIBusDescriptor_t (&buses)[BUS_COUNT])
+{
+  if (BUS_COUNT != NUMBER_OF_SPI_BUS)
+  {
+    return (false);
+  }
+
+  for (size_t bus = 0U; bus < BUS_COUNT; bus++)
+  {
+    if ((buses[bus].SPIBusID    != bus)                      ||
+        (buses[bus].IRQPriority == 0U)                       ||
+        (buses[bus].IRQPriority >= (1UL << __NVIC_PRIO_BITS))  )
+    {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+/* Bus completions resume awaiting tasks, so every bus must be masked by the coroutine critical sections */
+template<size_t BUS_COUNT>
+constexpr bool SPIBusesAreMaskedAt(const SPIBusDescriptor_t (&buses)[BUS_COUNT], uint32_t maskPriority)
+{
+  for (size_t bus = 0U; bus < BUS_COUNT; bus++)
+  {
+    if (buses[bus].IRQPriority < maskPriority)
+    {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+template<size_t DEVICE_COUNT>
+constexpr bool SPIDeviceBusesAreKnown(const SPIDeviceDescriptor_t (&devices)[DEVICE_COUNT])
+{
+  for (size_t device = 0U; device < DEVICE_COUNT; device++)
+  {
+    if (devices[device].SPIBusID >= NUMBER_OF_SPI_BUS)
+    {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+/* A chip select names a port and exactly one of its pins */
+template<size_t DEVICE_COUNT>
+constexpr bool SPIChipSelectsAreValid(const SPIDeviceDescriptor_t (&devices)[DEVICE_COUNT])
+{
+  for (size_t device = 0U; device < DEVICE_COUNT; device++)
+  {
+    uint16_t csPin = devices[device].csPin;
+
+    if ((devices[device].csPortAddress == 0U) ||
+        (csPin == 0U)                          ||
+        ((csPin & (csPin - 1U)) != 0U)           )
+    {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+/* Two devices on one chip select would both drive MISO, whichever bus each is listed on */
+template<size_t DEVICE_COUNT>
+constexpr bool SPIChipSelectsAreUnique(const SPIDeviceDescriptor_t (&devices)[DEVICE_COUNT])
+{
+  for (size_t device = 0U; device < DEVICE_COUNT; device++)
+  {
+    for (size_t other = device + 1U; other < DEVICE_COUNT; other++)
+    {
+      if ((devices[device].csPortAddress == devices[other].csPortAddress) &&
+          (devices[device].csPin         == devices[other].csPin)           )
+      {
+        return (false);
+      }
+    }
+  }
+
+  return (true);
+}
+
+
+/* Own settings must be ones applyDeviceConfig can write to CR1 */
+template<size_t DEVICE_COUNT>
+constexpr bool SPIBusConfigsAreValid(const SPIDeviceDescriptor_t (&devices)[DEVICE_COUNT])
+{
+  for (size_t device = 0U; device < DEVICE_COUNT; device++)
+  {
+    const SPI::SPIBusConfig_t& busConfig = devices[device].busConfig;
+
+    if (!devices[device].hasBusConfig)
+    {
+      continue;
+    }
+
+    if (((busConfig.baudRatePrescaler & ~SPI_CR1_BR) != 0U)                                              ||
+        ((busConfig.clockPolarity != SPI_POLARITY_LOW)  && (busConfig.clockPolarity != SPI_POLARITY_HIGH)) ||
+        ((busConfig.clockPhase    != SPI_PHASE_1EDGE)   && (busConfig.clockPhase    != SPI_PHASE_2EDGE))   ||
+        ((busConfig.dataSize      != SPI_DATASIZE_8BIT) && (busConfig.dataSize      != SPI_DATASIZE_16BIT))  )
+    {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+static_assert(SPIBusTopologyIsValid(SPI_BUS_TOPOLOGY), "SPI_BUS_TOPOLOGY must list every SPIBusID_t in order");
+
+static_assert((sizeof(SPI_DEVICE_TOPOLOGY) / sizeof(SPI_DEVICE_TOPOLOGY[0])) == NUMBER_OF_SPI_DEVICES,
+              "SPI_DEVICE_TOPOLOGY must list every SPIDeviceID_t in order");
+
+static_assert(SPIDeviceBusesAreKnown(SPI_DEVICE_TOPOLOGY),  "SPI device on an unknown bus");
+
+static_assert(SPIChipSelectsAreValid(SPI_DEVICE_TOPOLOGY),  "SPI chip select is not a single pin");
+
+static_assert(SPIChipSelectsAreUnique(SPI_DEVICE_TOPOLOGY), "SPI chip select shared by two devices");
+
+static_assert(SPIBusConfigsAreValid(SPI_DEVICE_TOPOLOGY),   "SPI device settings cannot be applied to CR1");
+
+
+
+#endif /* __SPITopology_H */
+
+/**
+  * @}End of File
+  */
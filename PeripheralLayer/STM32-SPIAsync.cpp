@@ -0,0 +1,159 @@
+/**
+  ******************************************************************************
+  * @file    STM32-SPIAsync.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains function definitions for awaiting SPI bus transfers
+  *          from coroutine tasks.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "STM32-SPIAsync.hpp"
+#include "SPITopology.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+static_assert(SPIBusesAreMaskedAt(SPI_BUS_TOPOLOGY, COROUTINE_IRQ_PRIORITY), "SPI bus priority is above COROUTINE_IRQ_PRIORITY");
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/* CLASS: SPITransferAwaiter --------------------------------------------------------*/
+
+SPITransferAwaiter::SPITransferAwaiter(SPI::SPIJob_t SPIJob):
+SPI()
+{
+  _SPIJob = SPIJob;
+}
+
+
+SPITransferAwaiter::SPITransferAwaiter(SPI::SPIJob_t SPIJob, SPI::SPIBusConfig_t busConfig):
+SPI(busConfig)
+{
+  _SPIJob = SPIJob;
+}
+
+
+bool SPITransferAwaiter::await_ready(void)
+{
+  return (false);
+}
+
+
+/* Returning false resumes the task straight away - the job never reached the queue */
+bool SPITransferAwaiter::await_suspend(Task::handle_t handle)
+{
+  _waiter.attach(handle);
+
+  _SPIJob.SPIObject = SPI::getObjectContext();
+
+  if (SPI::transmitReceiveAsync(_SPIJob) != STATUS_OK)
+  {
+    _waiter.detach();
+    return (false);
+  }
+
+  return (true);
+}
+
+
+status_t SPITransferAwaiter::await_resume(void)
+{
+  return (_waiter.getStatus());
+}
+
+
+void SPITransferAwaiter::transmitReceiveComplete(void)
+{
+  _waiter.complete(STATUS_OK);
+}
+
+
+void SPITransferAwaiter::transferError(void)
+{
+  _waiter.complete(STATUS_ERROR);
+}
+
+
+/* CLASS: AsyncSPIBus ---------------------------------------------------------------*/
+
+AsyncSPIBus::AsyncSPIBus(SPIBusID_t SPIBusID)
+{
+  _SPIBusID = SPIBusID;
+}
+
+
+/* Transfers from this bus handle run with their own clock/mode, as an SPI device with a config would */
+AsyncSPIBus::AsyncSPIBus(SPIBusID_t SPIBusID, SPI::SPIBusConfig_t busConfig)
+{
+  _SPIBusID     = SPIBusID;
+  _hasBusConfig = true;
+  _busConfig    = busConfig;
+}
+
+
+/**
+  * @brief   Builds an awaitable transfer of a job on this bus. co_await it from a Task to
+  *          queue the job and resume once it completes.
+  *
+  * @warning The job's SPIObject and SPIBusID are overwritten. Buffers must stay valid
+  *          until the co_await returns.
+  *
+  * @param   SPIJob: Job to run
+  *
+  * @retval  SPITransferAwaiter: Awaitable whose co_await yields the transfer status_t
+  */
+SPITransferAwaiter AsyncSPIBus::transfer(SPI::SPIJob_t SPIJob)
+{
+  SPIJob.SPIBusID = _SPIBusID;
+
+  if (_hasBusConfig)
+  {
+    return (SPITransferAwaiter(SPIJob, _busConfig));
+  }
+
+  return (SPITransferAwaiter(SPIJob));
+}
+
+
+SPITransferAwaiter AsyncSPIBus::transfer(GPIO_TypeDef* csPort, uint16_t csPin, uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length)
+{
+  SPI::SPIJob_t SPIJob = { .SPIObject           = NULL,
+                           .SPIBusID            = _SPIBusID,
+                           .csPort              = csPort,
+                           .csPin               = csPin,
+                           .txBuffer            = txBuffer,
+                           .rxBuffer            = rxBuffer,
+                           .length              = length,
+                           .chainedSegments     = NULL,
+                           .chainedSegmentCount = 0U,
+                           .queuedTimestamp     = 0U
+                         };
+
+  return (transfer(SPIJob));
+}
+
+
+/**
+  * @}End of File
+  */
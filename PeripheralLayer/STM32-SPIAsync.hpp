@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    STM32-SPIAsync.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the coroutine front end to the SPI job system, so a
+  *          task can co_await a bus transfer instead of deriving from SPI and
+  *          handling its completion callbacks.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __SPIAsync_H
+#define __SPIAsync_H
+
+/**************************************************************************************
+ * INCLUDES
+ *************************************************************************************/
+
+#include "STM32-SPIBus.hpp"
+#include "../Utilities/coroutineTask.hpp"
+
+
+/**************************************************************************************
+ * PROTOTYPES/CLASS DEFINITIONS
+ *************************************************************************************/
+
+/* Lives in the awaiting task's frame for the length of the transfer, acting as the job's SPI device */
+class SPITransferAwaiter:
+private SPI
+{
+
+  public:
+
+  /* Public Prototypes --------------------------------------------------------------*/
+
+  SPITransferAwaiter(SPI::SPIJob_t SPIJob);
+
+  SPITransferAwaiter(SPI::SPIJob_t SPIJob, SPI::SPIBusConfig_t busConfig);
+
+  bool await_ready(void);
+
+  bool await_suspend(Task::handle_t handle);
+
+  status_t await_resume(void);
+
+
+  private:
+
+  /* Private Variables --------------------------------------------------------------*/
+
+  SPI::SPIJob_t     _SPIJob;
+  AwaitingCoroutine _waiter;
+
+  /* Private Prototypes -------------------------------------------------------------*/
+
+  virtual void transmitReceiveComplete(void) final;
+
+  virtual void transferError(void) final;
+
+};
+
+
+class AsyncSPIBus
+{
+
+  public:
+
+  /* Public Prototypes --------------------------------------------------------------*/
+
+  AsyncSPIBus(SPIBusID_t SPIBusID);
+
+  AsyncSPIBus(SPIBusID_t SPIBusID, SPI::SPIBusConfig_t busConfig);
+
+  SPITransferAwaiter transfer(SPI::SPIJob_t SPIJob);
+
+  SPITransferAwaiter transfer(GPIO_TypeDef* csPort, uint16_t csPin, uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length);
+
+
+  private:
+
+  /* Private Variables --------------------------------------------------------------*/
+
+  SPIBusID_t          _SPIBusID;
+  bool                _hasBusConfig = false;
+  SPI::SPIBusConfig_t _busConfig;
+
+};
+
+
+#endif /* __SPIAsync_H */
+
+/**
+  * @}End of File
+  */
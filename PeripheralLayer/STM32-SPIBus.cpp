@@ -26,36 +26,233 @@
 /*************************************************************************************/
 
 #include "STM32-SPIBus.hpp"
-#include "spi.h"
+#include "SPITopology.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+/* Longest run of jobs pulled forward for sharing the active settings before the queue front is served */
+const uint8_t  SPI_MAX_GROUPED_JOB_RUN = 8U;
+
 
 /*************************************************************************************/
 /* CLASS OBJECTS                                                                     */
 /*************************************************************************************/
 
-SPIBus SPI_BUS_ARRAY[NUMBER_OF_SPI_BUS] = {
-                                            [SPI_BUS_1] = SPIBus(&hspi1)
-                                          };
+/* Built from the topology table at compile time - no constructor runs before main */
+constinit SPIBus SPI_BUS_ARRAY[NUMBER_OF_SPI_BUS] = {
+                                                      [SPI_BUS_1] = SPIBus(SPI_BUS_TOPOLOGY[SPI_BUS_1])
+                                                    };
 
 
 /*************************************************************************************/
 /* PRIVATE FUNCTION DEFINITIONS                                                      */
 /*************************************************************************************/
 
+static bool configsMatch(const SPI::SPIBusConfig_t& configA, const SPI::SPIBusConfig_t& configB)
+{
+  return ((configA.baudRatePrescaler == configB.baudRatePrescaler) &&
+          (configA.clockPolarity     == configB.clockPolarity)     &&
+          (configA.clockPhase        == configB.clockPhase)        &&
+          (configA.dataSize          == configB.dataSize)            );
+}
+
+
+/* Compare DMA request enable bit for a timer channel */
+static uint32_t getTimerDMARequest(uint32_t timerChannel)
+{
+  switch (timerChannel)
+  {
+    case TIM_CHANNEL_1: return (TIM_DMA_CC1);
+    case TIM_CHANNEL_2: return (TIM_DMA_CC2);
+    case TIM_CHANNEL_3: return (TIM_DMA_CC3);
+    default:            return (TIM_DMA_CC4);
+  }
+}
+
+
+/* DMA stream CubeMX linked to the stream's trigger channel compare request, NULL if none was */
+static DMA_HandleTypeDef* getTimerDMA(const SPI::SPIStream_t& SPIStream)
+{
+  switch (SPIStream.triggerChannel)
+  {
+    case TIM_CHANNEL_1: return (SPIStream.triggerTimer->hdma[TIM_DMA_ID_CC1]);
+    case TIM_CHANNEL_2: return (SPIStream.triggerTimer->hdma[TIM_DMA_ID_CC2]);
+    case TIM_CHANNEL_3: return (SPIStream.triggerTimer->hdma[TIM_DMA_ID_CC3]);
+    case TIM_CHANNEL_4: return (SPIStream.triggerTimer->hdma[TIM_DMA_ID_CC4]);
+    default:            return (NULL);
+  }
+}
+
+
+/* Stream rx ring events - the rx stream's parent is its SPI handle, so these reuse the SPI callback routing */
+static void streamRxHalfComplete(DMA_HandleTypeDef* hdma)
+{
+  HAL_SPI_TxRxHalfCpltCallback(static_cast<SPI_HandleTypeDef*>(hdma->Parent));
+}
+
+
+static void streamRxComplete(DMA_HandleTypeDef* hdma)
+{
+  HAL_SPI_TxRxCpltCallback(static_cast<SPI_HandleTypeDef*>(hdma->Parent));
+}
+
+
 /* CLASS: SPIBus --------------------------------------------------------------------*/
 
+bool SPIBus::deviceMatchesActiveConfig(const SPI* SPIObject)
+{
+  const SPI::SPIBusConfig_t& deviceConfig = SPIObject->_hasBusConfig ? SPIObject->_busConfig : _defaultConfig;
+
+  return (_activeConfigValid && configsMatch(deviceConfig, _activeConfig));
+}
+
+
+status_t SPIBus::applyDeviceConfig(const SPI* SPIObject)
+{
+  /* The CubeMX settings are only in the handle once MX_SPIx_Init has run, so capture them on first use.
+   * Only once - the handle's Init holds whichever device's settings were last applied after that */
+  if (!_defaultConfigCaptured)
+  {
+    _defaultConfig         = { .baudRatePrescaler = _spiHandle->Init.BaudRatePrescaler,
+                               .clockPolarity     = _spiHandle->Init.CLKPolarity,
+                               .clockPhase        = _spiHandle->Init.CLKPhase,
+                               .dataSize          = _spiHandle->Init.DataSize
+                             };
+    _activeConfig          = _defaultConfig;
+    _activeConfigValid     = true;
+    _defaultConfigCaptured = true;
+  }
+
+  if (deviceMatchesActiveConfig(SPIObject))
+  {
+    return (STATUS_OK);
+  }
+
+  const SPI::SPIBusConfig_t& jobConfig = SPIObject->_hasBusConfig ? SPIObject->_busConfig : _defaultConfig;
+
+  /* A frame size change also changes the DMA data width - the slow path, only taken when it actually differs.
+   * After a failed DMA init the streams' width is unknown, so they are always set again */
+  bool reinitDMA = !_activeConfigValid || (jobConfig.dataSize != _activeConfig.dataSize);
+
+  /* Refused before anything is touched, so the bus stays on its active settings */
+  if (reinitDMA && ((_spiHandle->hdmatx == NULL) || (_spiHandle->hdmarx == NULL)))
+  {
+    return (STATUS_ERROR);
+  }
+
+  /* Previous transfer has finished (HAL waits for BSY to clear), so CR1 can be rewritten with the peripheral disabled.
+   * HAL re-enables SPE when the next transfer starts */
+  __HAL_SPI_DISABLE(_spiHandle);
+
+  _spiHandle->Instance->CR1 = (_spiHandle->Instance->CR1 & ~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_DFF)) |
+                              jobConfig.baudRatePrescaler | jobConfig.clockPolarity | jobConfig.clockPhase | jobConfig.dataSize;
+
+  /* HAL reads the handle's Init to size DMA transfers, so keep it in step with the register */
+  _spiHandle->Init.BaudRatePrescaler = jobConfig.baudRatePrescaler;
+  _spiHandle->Init.CLKPolarity       = jobConfig.clockPolarity;
+  _spiHandle->Init.CLKPhase          = jobConfig.clockPhase;
+  _spiHandle->Init.DataSize          = jobConfig.dataSize;
+
+  if (reinitDMA)
+  {
+    bool halfWord = (jobConfig.dataSize == SPI_DATASIZE_16BIT);
+
+    _spiHandle->hdmatx->Init.PeriphDataAlignment = halfWord ? DMA_PDATAALIGN_HALFWORD : DMA_PDATAALIGN_BYTE;
+    _spiHandle->hdmatx->Init.MemDataAlignment    = halfWord ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+    _spiHandle->hdmarx->Init.PeriphDataAlignment = halfWord ? DMA_PDATAALIGN_HALFWORD : DMA_PDATAALIGN_BYTE;
+    _spiHandle->hdmarx->Init.MemDataAlignment    = halfWord ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+
+    /* Half the streams may be re-initialised, and CR1 is already rewritten - the active settings are unknown
+     * until a later job applies its own in full */
+    if ((HAL_DMA_Init(_spiHandle->hdmatx) != HAL_OK) ||
+        (HAL_DMA_Init(_spiHandle->hdmarx) != HAL_OK)   )
+    {
+      _activeConfigValid = false;
+      return (STATUS_ERROR);
+    }
+  }
+
+  _activeConfig      = jobConfig;
+  _activeConfigValid = true;
+
+  return (STATUS_OK);
+}
+
+
+void SPIBus::selectNextJob(void)
+{
+  if ((_schedulingPolicy != SPI_SCHEDULE_GROUP_BY_CONFIG) || !_activeConfigValid)
+  {
+    return;
+  }
+
+  /* Serve the front once the run limit is hit so devices with other settings are not starved */
+  if (_groupedJobRun >= SPI_MAX_GROUPED_JOB_RUN)
+  {
+    _groupedJobRun = 0U;
+    return;
+  }
+
+  for (int8_t position = 0; position < _jobQueue.getSize(); position++)
+  {
+    SPIJobQueue_t::return_t peekReturn = _jobQueue.peek(position);
+
+    if ((peekReturn.status == STATUS_OK) && deviceMatchesActiveConfig(peekReturn.data.SPIObject))
+    {
+      if (position == 0)
+      {
+        _groupedJobRun = 0U;
+      }
+      else
+      {
+        _jobQueue.moveToFront(position);
+        _groupedJobRun++;
+      }
+
+      return;
+    }
+  }
+}
+
+
+status_t SPIBus::startTransfer(uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length)
+{
+  HAL_StatusTypeDef HALStatus;
+
+  /* Rx-only clocks the rx buffer's own contents out, so neither direction needs a dummy buffer.
+   * Each kind completes through its own HAL callback - all three are routed to jobComplete */
+  if      (txBuffer == NULL) HALStatus = HAL_SPI_Receive_DMA(_spiHandle, rxBuffer, length);
+  else if (rxBuffer == NULL) HALStatus = HAL_SPI_Transmit_DMA(_spiHandle, txBuffer, length);
+  else                       HALStatus = HAL_SPI_TransmitReceive_DMA(_spiHandle, txBuffer, rxBuffer, length);
+
+  return ((HALStatus == HAL_OK) ? STATUS_OK : STATUS_ERROR);
+}
+
+
 void SPIBus::transmitReceiveFirstInQueue(void)
 {
 
-  QUEUE<SPI::SPIJob_t>::return_t queueReturn = _jobQueue.front();
+  SPIJobQueue_t::return_t queueReturn = _jobQueue.front();
 
   /* Start transmission if queue is not empty */
   if (queueReturn.status == STATUS_OK)
   {
-    SPI::SPIJob_t currentJob = queueReturn.data;
+    SPI::SPIJob_t currentJob   = queueReturn.data;
+
+    /* Peripheral is only reconfigured when this device's settings differ from the last job's */
+    status_t      configStatus = applyDeviceConfig(currentJob.SPIObject);
 
     HAL_GPIO_WritePin(currentJob.csPort, currentJob.csPin, GPIO_PIN_RESET);
 
-    if (HAL_SPI_TransmitReceive_DMA(_spiHandle, currentJob.txBuffer, currentJob.rxBuffer, currentJob.length) != HAL_OK)
+    /* Devices latch their sample on the chip select edge, so this is the sample's capture time.
+     * Held by the bus until completion - with pipelining the device may still be processing its previous job */
+    _activeJobTimestamp = GET_CYCLE_COUNT();
+    _activeSegment      = 0U;
+
+    if ((configStatus != STATUS_OK) ||
+        (startTransfer(currentJob.txBuffer, currentJob.rxBuffer, currentJob.length) != STATUS_OK))
     {
       jobComplete(STATUS_ERROR);
     }
@@ -63,18 +260,181 @@ void SPIBus::transmitReceiveFirstInQueue(void)
 
 }
 
-/*************************************************************************************/
-/* PUBLIC FUNCTION DEFINITIONS                                                       */
-/*************************************************************************************/
 
-/* CLASS: SPI -----------------------------------------------------------------------*/
+uint32_t SPIBus::enterCriticalSection(void)
+{
+  /* Only the bus's own completion interrupts touch its state, so leave higher priority interrupts (PWM, current loop) unmasked */
+  return (ENTER_PRIORITY_CRITICAL_SECTION(_IRQPriority));
+}
+
+
+void SPIBus::exitCriticalSection(uint32_t basepri)
+{
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+}
+
 
-SPI::SPI(void)
+status_t SPIBus::setStreamDMAMode(DMA_HandleTypeDef* txDMA, uint32_t DMAMode)
 {
+  if ((txDMA                 == NULL) ||
+      (_spiHandle->hdmarx    == NULL)   )
+  {
+    return (STATUS_ERROR);
+  }
+
+  /* The timer's stream writes SPI data items, so it takes the width the device's settings left the rx stream at */
+  txDMA->Init.Mode                = DMAMode;
+  txDMA->Init.PeriphDataAlignment = (_activeConfig.dataSize == SPI_DATASIZE_16BIT) ? DMA_PDATAALIGN_HALFWORD : DMA_PDATAALIGN_BYTE;
+  txDMA->Init.MemDataAlignment    = (_activeConfig.dataSize == SPI_DATASIZE_16BIT) ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+  _spiHandle->hdmarx->Init.Mode   = DMAMode;
+
+  if ((HAL_DMA_Init(txDMA)              != HAL_OK) ||
+      (HAL_DMA_Init(_spiHandle->hdmarx) != HAL_OK)   )
+  {
+    return (STATUS_ERROR);
+  }
+
+  return (STATUS_OK);
+}
+
+
+/* Job timestamps are DWT cycle counts - started here so every chip select edge the bus records is counted */
+void SPIBus::enableCycleCounter(void)
+{
+  if (!_cycleCounterEnabled)
+  {
+    ENABLE_CYCLE_COUNTER();
+    _cycleCounterEnabled = true;
+  }
+}
+
+
+status_t SPIBus::startStream(SPI::SPIStream_t SPIStream)
+{
+  /* The rx DMA handle is written before the DMA modes are set, so it is checked with the arguments */
+  if ((SPIStream.SPIObject    == NULL) ||
+      (SPIStream.triggerTimer == NULL) ||
+      (SPIStream.rxBuffer     == NULL) ||
+      (SPIStream.txBuffer     == NULL) ||
+      (SPIStream.frameLength  == 0U)   ||
+      (SPIStream.frameCount   == 0U)   ||
+      (_spiHandle->hdmarx     == NULL)   )
+  {
+    return (STATUS_ERROR);
+  }
+
+  uint32_t streamLength = static_cast<uint32_t>(SPIStream.frameLength) * SPIStream.frameCount;
+
+  if ((streamLength > UINT16_MAX) || (getTimerDMA(SPIStream) == NULL))
+  {
+    return (STATUS_ERROR);
+  }
+
+  enableCycleCounter();
+
+  /* A stream takes ownership of the whole bus, so it may only be started from idle */
+  uint32_t basepri = enterCriticalSection();
+
+  if (_streamActive || !_jobQueue.isEmpty())
+  {
+    exitCriticalSection(basepri);
+    return (STATUS_ERROR);
+  }
+
+  _stream       = SPIStream;
+  _streamActive = true;
+
+  exitCriticalSection(basepri);
 
+  DMA_HandleTypeDef* txDMA       = getTimerDMA(SPIStream);
+  uint32_t           dataAddress = reinterpret_cast<uintptr_t>(&_spiHandle->Instance->DR);
+
+  /* The SPI's own tx DMA request (TXE) is left off - an item is only clocked when the trigger timer's
+   * compare event DMAs it into the data register, so the timer alone sets the frame rate. The rx
+   * stream is circular over the whole ring and raises the half and full ring callbacks */
+  _spiHandle->hdmarx->XferHalfCpltCallback = streamRxHalfComplete;
+  _spiHandle->hdmarx->XferCpltCallback     = streamRxComplete;
+  _spiHandle->hdmarx->XferErrorCallback    = NULL;
+
+  if ((applyDeviceConfig(SPIStream.SPIObject)                                                                                        != STATUS_OK) ||
+      (setStreamDMAMode(txDMA, DMA_CIRCULAR)                                                                                          != STATUS_OK) ||
+      (HAL_DMA_Start_IT(_spiHandle->hdmarx, dataAddress, reinterpret_cast<uintptr_t>(SPIStream.rxBuffer), streamLength)              != HAL_OK)    ||
+      (HAL_DMA_Start(txDMA, reinterpret_cast<uintptr_t>(SPIStream.txBuffer), dataAddress, streamLength)                              != HAL_OK)      )
+  {
+    stopStream();
+    return (STATUS_ERROR);
+  }
+
+  SET_BIT(_spiHandle->Instance->CR2, SPI_CR2_RXDMAEN);
+  __HAL_SPI_ENABLE(_spiHandle);
+
+  __HAL_TIM_ENABLE_DMA(SPIStream.triggerTimer, getTimerDMARequest(SPIStream.triggerChannel));
+
+  if (HAL_TIM_PWM_Start(SPIStream.triggerTimer, SPIStream.triggerChannel) != HAL_OK)
+  {
+    stopStream();
+    return (STATUS_ERROR);
+  }
+
+  return (STATUS_OK);
 }
 
 
+status_t SPIBus::stopStream(void)
+{
+  /* Same lock as startStream, so a stop cannot interleave with a start or with the ring callbacks */
+  uint32_t basepri = enterCriticalSection();
+
+  if (!_streamActive)
+  {
+    exitCriticalSection(basepri);
+    return (STATUS_ERROR);
+  }
+
+  DMA_HandleTypeDef* txDMA = getTimerDMA(_stream);
+
+  HAL_TIM_PWM_Stop(_stream.triggerTimer, _stream.triggerChannel);
+  __HAL_TIM_DISABLE_DMA(_stream.triggerTimer, getTimerDMARequest(_stream.triggerChannel));
+
+  HAL_DMA_Abort(txDMA);
+  HAL_DMA_Abort(_spiHandle->hdmarx);
+  CLEAR_BIT(_spiHandle->Instance->CR2, SPI_CR2_RXDMAEN);
+
+  /* A last item may have landed after the rx stream stopped - drop it so the next job's rx DMA starts clean */
+  __HAL_SPI_CLEAR_OVRFLAG(_spiHandle);
+
+  status_t DMAStatus = setStreamDMAMode(txDMA, DMA_NORMAL);
+
+  _streamActive = false;
+
+  exitCriticalSection(basepri);
+
+  return (DMAStatus);
+}
+
+
+uint16_t SPIBus::getLatestStreamFrameIndex(const SPI* SPIObject)
+{
+  /* A stop leaves _stream as it was, so a stream stopping mid-read still gives a frame index in its ring */
+  if (!_streamActive || (_stream.SPIObject != SPIObject))
+  {
+    return (SPI_STREAM_NO_FRAME);
+  }
+
+  uint16_t streamLength  = _stream.frameLength * _stream.frameCount;
+  uint16_t bytesWritten  = streamLength - static_cast<uint16_t>(__HAL_DMA_GET_COUNTER(_spiHandle->hdmarx));
+  uint16_t framesWritten = bytesWritten / _stream.frameLength;
+
+  /* The frame currently being clocked in is incomplete - step back to the last full one, wrapping at the ring start */
+  return ((framesWritten == 0U) ? (_stream.frameCount - 1U) : (framesWritten - 1U));
+}
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/* CLASS: SPI -----------------------------------------------------------------------*/
+
 SPI* SPI::getObjectContext(void)
 {
   return (this);
@@ -87,60 +447,187 @@ status_t SPI::transmitReceiveAsync(SPIJob_t SPIJob)
 }
 
 
-/* CLASS: SPIBus --------------------------------------------------------------------*/
+status_t SPI::startStream(SPIStream_t SPIStream)
+{
+  return (SPI_BUS_ARRAY[SPIStream.SPIBusID].startStream(SPIStream));
+}
+
+
+status_t SPI::stopStream(SPIBusID_t SPIBusID)
+{
+  return (SPI_BUS_ARRAY[SPIBusID].stopStream());
+}
+
+
+uint16_t SPI::getLatestStreamFrameIndex(SPIBusID_t SPIBusID)
+{
+  return (SPI_BUS_ARRAY[SPIBusID].getLatestStreamFrameIndex(this));
+}
+
+
+uint32_t SPI::getTransferTimestamp(void)
+{
+  return (_transferTimestamp);
+}
+
+
+uint32_t SPI::getQueuedTimestamp(void)
+{
+  return (_queuedTimestamp);
+}
+
+
+uint32_t SPI::enterBusCriticalSection(SPIBusID_t SPIBusID)
+{
+  return (SPI_BUS_ARRAY[SPIBusID].enterCriticalSection());
+}
+
+
+void SPI::exitBusCriticalSection(SPIBusID_t SPIBusID, uint32_t basepri)
+{
+  SPI_BUS_ARRAY[SPIBusID].exitCriticalSection(basepri);
+}
+
+
+SPIBusOccupancy_t SPI::readBusOccupancy(SPIBusID_t SPIBusID)
+{
+  return (SPI_BUS_ARRAY[SPIBusID].readOccupancy());
+}
 
-SPIBus::SPIBus(SPI_HandleTypeDef* spiHandle)
+
+void SPI::setBusSchedulingPolicy(SPIBusID_t SPIBusID, SPISchedulingPolicy_t schedulingPolicy)
+{
+  SPI_BUS_ARRAY[SPIBusID].setSchedulingPolicy(schedulingPolicy);
+}
+
+
+void SPI::setBusCapture(SPIBusID_t SPIBusID, FrameCapture* capture)
 {
-  _spiHandle = spiHandle;
+  SPI_BUS_ARRAY[SPIBusID].setCapture(capture);
 }
 
 
+/* CLASS: SPIBus --------------------------------------------------------------------*/
+
 status_t SPIBus::addJobToQueue(SPI::SPIJob_t SPIJob)
 {
-  if ((SPIJob.SPIObject == NULL) ||
-      (SPIJob.rxBuffer  == NULL) ||
-      (SPIJob.txBuffer  == NULL)   )
+  if ((SPIJob.SPIObject == NULL)                                              ||
+      ((SPIJob.rxBuffer == NULL) && (SPIJob.txBuffer == NULL))                ||
+      (SPIJob.length    == 0U)                                                ||
+      ((SPIJob.chainedSegmentCount > 0U) && (SPIJob.chainedSegments == NULL)) ||
+      (_streamActive)                                                           )
   {
     return (STATUS_ERROR);
   }
 
-  /* Safely disable interrupts - if the SPI TXRX complete callback fired in this section, unexpected behaviour could occur */
-  uint32_t primask = ENTER_CRITICAL_SECTION();
+  for (uint8_t segment = 0U; segment < SPIJob.chainedSegmentCount; segment++)
+  {
+    if (((SPIJob.chainedSegments[segment].rxBuffer == NULL) && (SPIJob.chainedSegments[segment].txBuffer == NULL)) ||
+        (SPIJob.chainedSegments[segment].length == 0U)                                                                )
+    {
+      return (STATUS_ERROR);
+    }
+  }
+
+  enableCycleCounter();
+
+  /* Mask the bus interrupts - if the SPI TXRX complete callback fired in this section, unexpected behaviour could occur.
+   * Submitters running above the bus priority are not masked against each other so must not submit to this bus */
+  uint32_t basepri = enterCriticalSection();
 
   int8_t queueCountPrePush = _jobQueue.getSize();
 
-  /* Add to SPI bus job queue if queue is not full */
-  if (_jobQueue.push(SPIJob) == STATUS_OK)
+  SPIJob.queuedTimestamp   = GET_CYCLE_COUNT();
+
+  /* A full queue must be reported - awaiting submitters would otherwise park on a job that never runs */
+  status_t pushStatus      = _jobQueue.push(SPIJob);
+
+  if ((pushStatus == STATUS_OK) && (queueCountPrePush == 0))
   {
-    if (queueCountPrePush == 0)
-    {
-      transmitReceiveFirstInQueue();
-    }
+    transmitReceiveFirstInQueue();
   }
 
-  EXIT_CRITICAL_SECTION(primask);
+  exitCriticalSection(basepri);
 
-  return (STATUS_OK);
+  return (pushStatus);
 }
 
 
 void SPIBus::jobComplete(status_t transferStatus)
 {
-  QUEUE<SPI::SPIJob_t>::return_t frontReturn = _jobQueue.front();
+  /* Full-buffer event of a circular stream - the DMA keeps running so there is no job to retire */
+  if (_streamActive)
+  {
+    _stream.SPIObject->streamComplete();
+    return;
+  }
+
+  SPIJobQueue_t::return_t frontReturn = _jobQueue.front();
 
   /* End transmission if queue is not empty */
   if (frontReturn.status == STATUS_OK)
   {
-    SPI::SPIJob_t currentJob = frontReturn.data;
+    SPI::SPIJob_t currentJob       = frontReturn.data;
+    uint32_t      currentTimestamp = _activeJobTimestamp;
+
+    /* Chained segments continue under the same chip select - the job only completes after its last segment */
+    if ((transferStatus == STATUS_OK) && (_activeSegment < currentJob.chainedSegmentCount))
+    {
+      const SPI::SPISegment_t& nextSegment = currentJob.chainedSegments[_activeSegment];
+
+      _activeSegment++;
+
+      if (startTransfer(nextSegment.txBuffer, nextSegment.rxBuffer, nextSegment.length) == STATUS_OK)
+      {
+        return;
+      }
+
+      transferStatus = STATUS_ERROR;
+    }
 
     HAL_GPIO_WritePin(currentJob.csPort, currentJob.csPin, GPIO_PIN_SET);
 
-    if (transferStatus == STATUS_OK) currentJob.SPIObject->transmitReceiveComplete();
-    else                             currentJob.SPIObject->transferError();
+    _busyCycles += GET_CYCLE_COUNT() - currentTimestamp;
+    _completedJobCount++;
 
     _jobQueue.pop();
 
-    if (_jobQueue.getSize() > 0)
+    selectNextJob();
+
+    SPIJobQueue_t::return_t nextReturn = _jobQueue.front();
+
+    /* Arm the next transfer before dispatching, so the device callback (CRC, decode) overlaps it on the wire.
+     * A job reusing the same rx buffer must wait, or the DMA would overwrite data the callback is reading */
+    bool pipelineNext = (nextReturn.status == STATUS_OK) &&
+                        ((nextReturn.data.rxBuffer == NULL) || (nextReturn.data.rxBuffer != currentJob.rxBuffer));
+
+    if (pipelineNext)
+    {
+      transmitReceiveFirstInQueue();
+    }
+
+    /* Record exactly what came off the wire - for chained jobs only the first segment is captured. Done once
+     * the next job is on the wire, so capture never delays it; a pipelined job never shares this rx buffer */
+    FrameCapture* capture = _capture;
+
+    if ((capture != NULL) && (transferStatus == STATUS_OK) && (currentJob.rxBuffer != NULL))
+    {
+      /* Job lengths are in frames - a 16-bit frame is two bytes of the rx buffer */
+      const SPI::SPIBusConfig_t& jobConfig  = currentJob.SPIObject->_hasBusConfig ? currentJob.SPIObject->_busConfig : _defaultConfig;
+      uint32_t                   frameBytes = (jobConfig.dataSize == SPI_DATASIZE_16BIT) ? 2U : 1U;
+
+      capture->append(CHIP_SELECT_DEVICE_ID(currentJob.csPort, currentJob.csPin), currentTimestamp, currentJob.rxBuffer,
+                      currentJob.length * frameBytes);
+    }
+
+    currentJob.SPIObject->_transferTimestamp = currentTimestamp;
+    currentJob.SPIObject->_queuedTimestamp   = currentJob.queuedTimestamp;
+
+    if (transferStatus == STATUS_OK) currentJob.SPIObject->transmitReceiveComplete();
+    else                             currentJob.SPIObject->transferError();
+
+    /* The callback may have queued (and so started) a job itself if the queue ran empty */
+    if (!pipelineNext && (nextReturn.status == STATUS_OK))
     {
       transmitReceiveFirstInQueue();
     }
@@ -148,6 +635,48 @@ void SPIBus::jobComplete(status_t transferStatus)
 }
 
 
+void SPIBus::setSchedulingPolicy(SPISchedulingPolicy_t schedulingPolicy)
+{
+  _schedulingPolicy = schedulingPolicy;
+}
+
+
+void SPIBus::setCapture(FrameCapture* capture)
+{
+  _capture = capture;
+}
+
+
+SPIBusOccupancy_t SPIBus::readOccupancy(void)
+{
+  /* Each read restarts the window - read more often than the cycle counter wraps (~25 s at 168 MHz) */
+  uint32_t basepri = enterCriticalSection();
+
+  uint32_t now = GET_CYCLE_COUNT();
+
+  SPIBusOccupancy_t occupancy = { .busyCycles    = _busyCycles,
+                                  .elapsedCycles = now - _occupancyWindowStart,
+                                  .jobCount      = _completedJobCount
+                                };
+
+  _busyCycles           = 0U;
+  _completedJobCount    = 0U;
+  _occupancyWindowStart = now;
+
+  exitCriticalSection(basepri);
+
+  return (occupancy);
+}
+
+
+void SPIBus::streamHalfComplete(void)
+{
+  if (_streamActive)
+  {
+    _stream.SPIObject->streamHalfComplete();
+  }
+}
+
 /*************************************************************************************/
 /* INTERRUPT HANDLERS                                                                */
 /*************************************************************************************/
@@ -169,6 +698,56 @@ void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
 }
 
 
+/**
+  * @brief Tx Transfer completed callback - raised by tx-only jobs.
+  *
+  * @param  hspi pointer to a SPI_HandleTypeDef structure that contains
+  *               the configuration information for SPI module.
+  * @retval None
+  */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi->Instance == SPI1)                                      // @suppress("C-Style cast instead of C++ cast")
+  {
+    SPI_BUS_ARRAY[SPI_BUS_1].jobComplete(STATUS_OK);
+  }
+}
+
+
+/**
+  * @brief Rx Transfer completed callback - raised by rx-only jobs. In full-duplex master mode
+  *        the HAL clocks these as a TransmitReceive of the rx buffer but completes them here.
+  *
+  * @param  hspi pointer to a SPI_HandleTypeDef structure that contains
+  *               the configuration information for SPI module.
+  * @retval None
+  */
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi->Instance == SPI1)                                      // @suppress("C-Style cast instead of C++ cast")
+  {
+    SPI_BUS_ARRAY[SPI_BUS_1].jobComplete(STATUS_OK);
+  }
+}
+
+
+/**
+  * @brief Tx and Rx Half Transfer callback - only raised by buses running a circular stream,
+  *        from the stream's rx DMA.
+  *
+  * @param  hspi pointer to a SPI_HandleTypeDef structure that contains
+  *               the configuration information for SPI module.
+  * @retval None
+  */
+void HAL_SPI_TxRxHalfCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi->Instance == SPI1)                                      // @suppress("C-Style cast instead of C++ cast")
+  {
+    SPI_BUS_ARRAY[SPI_BUS_1].streamHalfComplete();
+  }
+}
+
+
 /**
   * @}End of File
   */
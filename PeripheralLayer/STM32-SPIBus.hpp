@@ -31,6 +31,7 @@
 
 #include "gpio.h"
 #include "../Utilities/queue.hpp"
+#include "../Utilities/frameCapture.hpp"
 
 
 /**************************************************************************************
@@ -44,6 +45,44 @@ typedef enum: uint8_t
 } SPIBusID_t;
 
 
+typedef enum: uint8_t
+{
+  SPI_SCHEDULE_FIFO            = 0,
+  SPI_SCHEDULE_GROUP_BY_CONFIG = 1,
+} SPISchedulingPolicy_t;
+
+
+/* Bus time spent with a chip select asserted over a measurement window, in core clock cycles */
+typedef struct
+{
+  uint32_t busyCycles;
+  uint32_t elapsedCycles;
+  uint32_t jobCount;
+
+} SPIBusOccupancy_t;
+
+
+/* One bus in the topology table (SPITopology.hpp) - the IRQ priority must match the NVIC
+ * priority CubeMX gives the SPI and its DMA streams */
+typedef struct
+{
+  SPIBusID_t         SPIBusID;
+  SPI_HandleTypeDef* spiHandle;
+  uint32_t           IRQPriority;
+
+} SPIBusDescriptor_t;
+
+
+/**************************************************************************************
+ * CONSTANTS
+ *************************************************************************************/
+
+const int8_t   SPI_JOB_QUEUE_SIZE  = 32;
+
+/* Frame index returned to a device which does not own the bus's running stream */
+const uint16_t SPI_STREAM_NO_FRAME = UINT16_MAX;
+
+
 /**************************************************************************************
  * PROTOTYPES/CLASS DEFINITIONS
  *************************************************************************************/
@@ -56,22 +95,78 @@ class SPI
 
   /* Public Constants ---------------------------------------------------------------*/
 
+  /* A NULL txBuffer makes a segment rx-only (the rx buffer is clocked out), a NULL rxBuffer makes it tx-only */
   typedef struct
   {
-	  SPI*          SPIObject;
-	  SPIBusID_t    SPIBusID;
-	  GPIO_TypeDef* csPort;
-	  uint16_t      csPin;
-	  uint8_t*      txBuffer;
-	  uint8_t*      rxBuffer;
-	  uint8_t       length;
+    uint8_t*      txBuffer;
+    uint8_t*      rxBuffer;
+    uint16_t      length;
+
+  } SPISegment_t;
+
+
+  /* The job's own buffers are the first segment - any chained segments follow under the same chip select.
+   * Lengths are in frames: bytes for 8-bit frames, half-words for 16-bit frames. queuedTimestamp is
+   * stamped by the bus as the job is queued - any value the submitter sets is overwritten */
+  typedef struct
+  {
+	  SPI*                SPIObject;
+	  SPIBusID_t          SPIBusID;
+	  GPIO_TypeDef*       csPort;
+	  uint16_t            csPin;
+	  uint8_t*            txBuffer;
+	  uint8_t*            rxBuffer;
+	  uint16_t            length;
+	  const SPISegment_t* chainedSegments;
+	  uint8_t             chainedSegmentCount;
+	  uint32_t            queuedTimestamp;
 
   } SPIJob_t;
 
 
+  /* Streams are paced by the trigger timer alone: each compare event on triggerChannel DMAs one data
+   * item of the tx ring into the SPI data register, and the SPI's rx DMA collects the ring. CubeMX setup:
+   *  - trigger timer: one whose DMA controller reaches the SPI (TIM1/TIM8 for SPI1 on DMA2), triggerChannel
+   *    in PWM mode, period one data item slot (longer than an item takes to clock), and a DMA request on
+   *    that channel - memory to peripheral, memory increment
+   *  - SPI: rx DMA only is used while streaming, the tx stream is left idle
+   *  - chip select: the triggerChannel PWM output for one-item frames. Longer frames take it from a frame
+   *    timer slaved to the trigger timer's update (external clock mode 1, period frameLength), started
+   *    by the application before the stream
+   * The bus sets both DMA streams circular, and the data width from the device's bus config */
+  typedef struct
+  {
+    SPI*               SPIObject;
+    SPIBusID_t         SPIBusID;
+    TIM_HandleTypeDef* triggerTimer;
+    uint32_t           triggerChannel;
+    uint8_t*           txBuffer;
+    uint8_t*           rxBuffer;
+    uint16_t           frameLength;
+    uint16_t           frameCount;
+
+  } SPIStream_t;
+
+
+  /* Peripheral settings a device needs - field values are the HAL SPI_InitTypeDef constants */
+  typedef struct
+  {
+    uint32_t baudRatePrescaler;
+    uint32_t clockPolarity;
+    uint32_t clockPhase;
+    uint32_t dataSize;
+
+  } SPIBusConfig_t;
+
+
   /* Public Prototypes --------------------------------------------------------------*/
 
-  SPI(void);
+  /* Constructors are constexpr so devices can be constant-initialised - see SPITopology.hpp */
+  constexpr SPI(void) {}
+
+  constexpr SPI(SPIBusConfig_t busConfig) : _hasBusConfig(true), _busConfig(busConfig) {}
+
+  constexpr SPI(bool hasBusConfig, SPIBusConfig_t busConfig) : _hasBusConfig(hasBusConfig), _busConfig(busConfig) {}
 
   virtual ~SPI() {};
 
@@ -79,15 +174,52 @@ class SPI
 
   status_t transmitReceiveAsync(SPIJob_t SPIJob);
 
+  status_t startStream(SPIStream_t SPIStream);
+
+  status_t stopStream(SPIBusID_t SPIBusID);
+
+  uint16_t getLatestStreamFrameIndex(SPIBusID_t SPIBusID);
+
+  uint32_t getTransferTimestamp(void);
+
+  uint32_t getQueuedTimestamp(void);
+
+  uint32_t enterBusCriticalSection(SPIBusID_t SPIBusID);
+
+  void exitBusCriticalSection(SPIBusID_t SPIBusID, uint32_t basepri);
+
+  static SPIBusOccupancy_t readBusOccupancy(SPIBusID_t SPIBusID);
+
+  static void setBusSchedulingPolicy(SPIBusID_t SPIBusID, SPISchedulingPolicy_t schedulingPolicy);
+
+  static void setBusCapture(SPIBusID_t SPIBusID, FrameCapture* capture);
+
 
   private:
 
+  /* Private Variables --------------------------------------------------------------*/
+
+  /* Cycle count captured by the bus as chip select was asserted for this device's last job */
+  volatile uint32_t _transferTimestamp = 0U;
+
+  /* Cycle count at which that job was queued - carried with the job, so it survives other jobs queued behind it */
+  volatile uint32_t _queuedTimestamp   = 0U;
+
+  /* Devices without their own settings run with the bus as configured by CubeMX */
+  bool              _hasBusConfig      = false;
+  SPIBusConfig_t    _busConfig         = {0U, 0U, 0U, 0U};
+
   /* Private Prototypes -------------------------------------------------------------*/
 
   virtual void transmitReceiveComplete(void) = 0;
 
   virtual void transferError(void) = 0;
 
+  /* Stream callbacks are optional - only devices which stream need to override them */
+  virtual void streamHalfComplete(void) {};
+
+  virtual void streamComplete(void) {};
+
 
   /* Friend Class Declarations ------------------------------------------------------*/
 
@@ -103,23 +235,85 @@ class SPIBus
 
   /* Public Functions --------------------------------------------------------------*/
 
-  SPIBus(SPI_HandleTypeDef* spiHandle);
+  constexpr SPIBus(SPI_HandleTypeDef* spiHandle, uint32_t IRQPriority) : _spiHandle(spiHandle), _IRQPriority(IRQPriority) {}
+
+  constexpr SPIBus(const SPIBusDescriptor_t& descriptor) : SPIBus(descriptor.spiHandle, descriptor.IRQPriority) {}
 
   void jobComplete(status_t transferStatus);
 
+  void streamHalfComplete(void);
+
+  SPIBusOccupancy_t readOccupancy(void);
+
+  void setSchedulingPolicy(SPISchedulingPolicy_t schedulingPolicy);
+
+  void setCapture(FrameCapture* capture);
+
 
   private:
 
+  /* Private Typedefs ---------------------------------------------------------------*/
+
+  typedef QUEUE<SPI::SPIJob_t, SPI_JOB_QUEUE_SIZE> SPIJobQueue_t;
+
+
   /* Private Variables --------------------------------------------------------------*/
 
-  SPI_HandleTypeDef*   _spiHandle = NULL;
-  QUEUE<SPI::SPIJob_t> _jobQueue;
+  SPI_HandleTypeDef*    _spiHandle = NULL;
+  SPIJobQueue_t         _jobQueue;
+
+  /* Highest (numerically lowest) NVIC priority of the bus's SPI and DMA interrupts */
+  uint32_t              _IRQPriority          = 0U;
+
+  uint32_t              _activeJobTimestamp   = 0U;
+  uint32_t              _busyCycles           = 0U;
+  uint32_t              _completedJobCount    = 0U;
+  uint32_t              _occupancyWindowStart = 0U;
+
+  SPISchedulingPolicy_t _schedulingPolicy     = SPI_SCHEDULE_FIFO;
+  uint8_t               _groupedJobRun        = 0U;
+  uint8_t               _activeSegment        = 0U;
+
+  bool                  _defaultConfigCaptured = false;
+  bool                  _activeConfigValid    = false;
+  SPI::SPIBusConfig_t   _activeConfig         = {0U, 0U, 0U, 0U};
+  SPI::SPIBusConfig_t   _defaultConfig        = {0U, 0U, 0U, 0U};
+
+  FrameCapture* volatile _capture             = NULL;
+
+  volatile bool         _streamActive         = false;
+  SPI::SPIStream_t      _stream               = {NULL, SPI_BUS_1, NULL, 0U, NULL, NULL, 0U, 0U};
+
+  /* The DWT counter is started by the first transfer rather than at construction, so buses need no startup code */
+  bool                  _cycleCounterEnabled  = false;
 
 
   /* Private Functions --------------------------------------------------------------*/
 
   status_t addJobToQueue(SPI::SPIJob_t SPIJob);
 
+  status_t startStream(SPI::SPIStream_t SPIStream);
+
+  status_t stopStream(void);
+
+  uint16_t getLatestStreamFrameIndex(const SPI* SPIObject);
+
+  status_t setStreamDMAMode(DMA_HandleTypeDef* txDMA, uint32_t DMAMode);
+
+  void enableCycleCounter(void);
+
+  void selectNextJob(void);
+
+  bool deviceMatchesActiveConfig(const SPI* SPIObject);
+
+  status_t applyDeviceConfig(const SPI* SPIObject);
+
+  uint32_t enterCriticalSection(void);
+
+  void exitCriticalSection(uint32_t basepri);
+
+  status_t startTransfer(uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length);
+
   void transmitReceiveFirstInQueue(void);
 
   void abortJob(void);
@@ -0,0 +1,238 @@
+/**
+  ******************************************************************************
+  * @file    captureDecoder.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side tool which batch decodes the Orbis position frames in a
+  *          raw SPI frame capture and reports decode throughput.
+  *
+  *          Usage: captureDecoder <capture.bin> [frames.csv]
+  *
+  *          Build with Utilities/orbisBatchDecode.cpp and -O2 -march=native
+  *          (or -mavx2 / -mssse3) to get the vector path. Every 3-byte record
+  *          is decoded with both the vector and scalar paths, which must agree
+  *          exactly, and each is timed over repeated passes to give frames per
+  *          second. Frames are written as "deviceID,timestamp,position,status,
+  *          crcPass" lines to the output file when one is given.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../Utilities/frameCaptureFormat.hpp"
+#include "../Utilities/orbisBatchDecode.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+/* Small captures are decoded repeatedly until this long has been spent on each path */
+const double MINIMUM_BENCHMARK_SECONDS = 0.5;
+
+/*************************************************************************************/
+/* PRIVATE TYPEDEFS                                                                  */
+/*************************************************************************************/
+
+typedef void (OrbisBatchDecoder::*DecodeFunction_t)(const uint8_t*, uint32_t, uint16_t*, uint8_t*, uint8_t*);
+
+typedef struct
+{
+  std::vector<uint16_t> positions;
+  std::vector<uint8_t>  statuses;
+  std::vector<uint8_t>  CRCPass;
+
+} DecodeResults_t;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/**
+  * @brief  Decodes all frames repeatedly with one path, returning frames per second
+  */
+static double benchmark(OrbisBatchDecoder& decoder, DecodeFunction_t decodeFunction, const std::vector<uint8_t>& frames, DecodeResults_t& results)
+{
+  uint32_t frameCount = static_cast<uint32_t>(frames.size() / ORBIS_BATCH_FRAME_SIZE);
+  uint64_t decoded    = 0U;
+  double   elapsed    = 0.0;
+
+  results.positions.resize(frameCount);
+  results.statuses.resize(frameCount);
+  results.CRCPass.resize(frameCount);
+
+  auto start = std::chrono::steady_clock::now();
+
+  do
+  {
+    (decoder.*decodeFunction)(frames.data(), frameCount, results.positions.data(), results.statuses.data(), results.CRCPass.data());
+
+    decoded += frameCount;
+    elapsed  = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  } while (elapsed < MINIMUM_BENCHMARK_SECONDS);
+
+  return (decoded / elapsed);
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s <capture.bin> [frames.csv]\n", argv[0]);
+    return (EXIT_FAILURE);
+  }
+
+  FILE* input = std::fopen(argv[1], "rb");
+
+  if (input == NULL)
+  {
+    std::perror(argv[1]);
+    return (EXIT_FAILURE);
+  }
+
+  std::vector<uint8_t> dump;
+  uint8_t              chunk[4096];
+  size_t               chunkLength;
+
+  while ((chunkLength = std::fread(chunk, 1U, sizeof(chunk), input)) > 0U)
+  {
+    dump.insert(dump.end(), chunk, chunk + chunkLength);
+  }
+
+  std::fclose(input);
+
+  if ((dump.size() < FRAME_CAPTURE_HEADER_SIZE)      ||
+      (dump[0] != FRAME_CAPTURE_MAGIC_0)             ||
+      (dump[1] != FRAME_CAPTURE_MAGIC_1)             ||
+      (dump[2] != FRAME_CAPTURE_FORMAT_VERSION)        )
+  {
+    std::fprintf(stderr, "%s is not a version %u frame capture\n", argv[1], FRAME_CAPTURE_FORMAT_VERSION);
+    return (EXIT_FAILURE);
+  }
+
+  /* Pack the position frames back to back, keeping their record headers for the CSV */
+  std::vector<uint8_t>  frames;
+  std::vector<uint8_t>  deviceIDs;
+  std::vector<uint32_t> timestamps;
+  size_t                offset = FRAME_CAPTURE_HEADER_SIZE;
+
+  while ((dump.size() - offset) >= FRAME_CAPTURE_RECORD_HEADER_SIZE)
+  {
+    const uint8_t* record      = &dump[offset];
+    uint8_t        frameLength = record[FRAME_CAPTURE_OFFSET_LENGTH];
+
+    if ((dump.size() - offset) < static_cast<size_t>(FRAME_CAPTURE_RECORD_HEADER_SIZE + frameLength))
+    {
+      std::fprintf(stderr, "truncated record at offset %lu\n", static_cast<unsigned long>(offset));
+      break;
+    }
+
+    offset += FRAME_CAPTURE_RECORD_HEADER_SIZE + frameLength;
+
+    if (frameLength != ORBIS_BATCH_FRAME_SIZE)
+    {
+      continue;
+    }
+
+    uint32_t timestamp;
+    std::memcpy(&timestamp, &record[FRAME_CAPTURE_OFFSET_TIMESTAMP], sizeof(timestamp));
+
+    frames.insert(frames.end(), &record[FRAME_CAPTURE_OFFSET_FRAME], &record[FRAME_CAPTURE_OFFSET_FRAME + frameLength]);
+    deviceIDs.push_back(record[FRAME_CAPTURE_OFFSET_DEVICE_ID]);
+    timestamps.push_back(timestamp);
+  }
+
+  uint32_t frameCount = static_cast<uint32_t>(deviceIDs.size());
+
+  if (frameCount == 0U)
+  {
+    std::fprintf(stderr, "no position frames in %s\n", argv[1]);
+    return (EXIT_FAILURE);
+  }
+
+  OrbisBatchDecoder decoder;
+  DecodeResults_t   vectorResults;
+  DecodeResults_t   scalarResults;
+
+  double vectorRate = benchmark(decoder, &OrbisBatchDecoder::decode,       frames, vectorResults);
+  double scalarRate = benchmark(decoder, &OrbisBatchDecoder::decodeScalar, frames, scalarResults);
+
+  if ((vectorResults.positions != scalarResults.positions) ||
+      (vectorResults.statuses  != scalarResults.statuses)  ||
+      (vectorResults.CRCPass   != scalarResults.CRCPass)     )
+  {
+    std::fprintf(stderr, "%s decode disagrees with the scalar decode\n", OrbisBatchDecoder::getImplementationName());
+    return (EXIT_FAILURE);
+  }
+
+  uint32_t CRCFailCount     = 0U;
+  uint32_t statusErrorCount = 0U;
+
+  for (uint32_t frame = 0U; frame < frameCount; frame++)
+  {
+    if (vectorResults.CRCPass[frame] == 0U)
+    {
+      CRCFailCount++;
+    }
+    else if (vectorResults.statuses[frame] != ORBIS_BATCH_STATUS_MASK)
+    {
+      statusErrorCount++;
+    }
+  }
+
+  if (argc > 2)
+  {
+    FILE* output = std::fopen(argv[2], "w");
+
+    if (output == NULL)
+    {
+      std::perror(argv[2]);
+      return (EXIT_FAILURE);
+    }
+
+    for (uint32_t frame = 0U; frame < frameCount; frame++)
+    {
+      std::fprintf(output, "%u,%lu,%u,%u,%u\n", deviceIDs[frame], static_cast<unsigned long>(timestamps[frame]),
+                   vectorResults.positions[frame], vectorResults.statuses[frame], vectorResults.CRCPass[frame]);
+    }
+
+    std::fclose(output);
+  }
+
+  std::fprintf(stderr, "%lu frames: %lu CRC failures, %lu status errors\n",
+               static_cast<unsigned long>(frameCount), static_cast<unsigned long>(CRCFailCount),
+               static_cast<unsigned long>(statusErrorCount));
+  std::fprintf(stderr, "%s: %.1f Mframes/s, scalar: %.1f Mframes/s (%.1fx)\n",
+               OrbisBatchDecoder::getImplementationName(), vectorRate / 1e6, scalarRate / 1e6, vectorRate / scalarRate);
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
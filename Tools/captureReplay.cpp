@@ -0,0 +1,169 @@
+/**
+  ******************************************************************************
+  * @file    captureReplay.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side tool which replays one device's frames from a raw SPI
+  *          frame capture through the encoder driver's own decode path, on a
+  *          replay encoder instance of its own, and reports the CRC and status
+  *          statistics the driver would have seen live.
+  *
+  *          Usage: captureReplay <capture.bin> <deviceID> [resolution]
+  *
+  *          deviceID is the record's device ID ((port index << 4) | pin, e.g.
+  *          0x04 for PA4), resolution the Orbis variant in bits (14, 13 or 12,
+  *          default 14). Build with DeviceLayer/encoder.cpp,
+  *          PeripheralLayer/STM32-SPIBus.cpp, every Utilities source,
+  *          Tools/hostHAL/hostHAL.cpp and -ITools/hostHAL.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../DeviceLayer/encoder.hpp"
+#include "../Utilities/frameCaptureFormat.hpp"
+
+/*************************************************************************************/
+/* REPLAY ENCODER                                                                    */
+/*************************************************************************************/
+
+/* Never fetches and has nothing attached, so replay only ever touches this instance.
+ * The chip select is a placeholder - frames are picked by the captured device ID */
+template<typename ENCODER_TRAITS>
+class ReplayEncoder:
+public SPIEncoder<ENCODER_TRAITS>
+{
+
+  public:
+
+  ReplayEncoder(void) : SPIEncoder<ENCODER_TRAITS>(REPLAY_DEVICE) {}
+
+  private:
+
+  static constexpr SPIDeviceDescriptor_t REPLAY_DEVICE = { .SPIBusID = SPI_BUS_1, .csPortAddress = GPIOA_BASE, .csPin = GPIO_PIN_0 };
+
+  virtual void positionFetchComplete(status_t positionFetchStatus) final
+  {
+    (void)positionFetchStatus;
+  }
+
+};
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/**
+  * @brief  Replays the capture into a fresh encoder of one variant and prints its statistics
+  */
+template<typename ENCODER_TRAITS>
+static int replay(const std::vector<uint8_t>& dump, uint8_t deviceID)
+{
+  typedef typename SPIEncoder<ENCODER_TRAITS>::ReplayStatistics_t ReplayStatistics_t;
+
+  ReplayEncoder<ENCODER_TRAITS> encoder;
+
+  auto               start            = std::chrono::steady_clock::now();
+  ReplayStatistics_t replayStatistics = encoder.replayCapture(dump.data(), static_cast<uint32_t>(dump.size()), deviceID);
+  double             elapsed          = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (replayStatistics.frameCount == 0U)
+  {
+    std::fprintf(stderr, "no %u-byte frames from device 0x%02X\n", ENCODER_TRAITS::FRAME_SIZE_IN_BYTES, deviceID);
+    return (EXIT_FAILURE);
+  }
+
+  std::fprintf(stderr, "%lu frames: %lu valid, %lu CRC failures, %lu status errors\n",
+               static_cast<unsigned long>(replayStatistics.frameCount), static_cast<unsigned long>(replayStatistics.validCount),
+               static_cast<unsigned long>(replayStatistics.CRCFailCount), static_cast<unsigned long>(replayStatistics.statusErrorCount));
+  std::fprintf(stderr, "last valid position %u, %.1f Mframes/s\n",
+               encoder.getLastValidPosition(), (elapsed > 0.0) ? (replayStatistics.frameCount / elapsed / 1e6) : 0.0);
+
+  return (EXIT_SUCCESS);
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::fprintf(stderr, "usage: %s <capture.bin> <deviceID> [resolution]\n", argv[0]);
+    return (EXIT_FAILURE);
+  }
+
+  char*         end;
+  unsigned long deviceID   = std::strtoul(argv[2], &end, 0);
+  unsigned long resolution = (argc > 3) ? std::strtoul(argv[3], NULL, 0) : 14UL;
+
+  if ((*end != '\0') || (deviceID > UINT8_MAX))
+  {
+    std::fprintf(stderr, "bad device ID %s\n", argv[2]);
+    return (EXIT_FAILURE);
+  }
+
+  FILE* input = std::fopen(argv[1], "rb");
+
+  if (input == NULL)
+  {
+    std::perror(argv[1]);
+    return (EXIT_FAILURE);
+  }
+
+  std::vector<uint8_t> dump;
+  uint8_t              chunk[4096];
+  size_t               chunkLength;
+
+  while ((chunkLength = std::fread(chunk, 1U, sizeof(chunk), input)) > 0U)
+  {
+    dump.insert(dump.end(), chunk, chunk + chunkLength);
+  }
+
+  std::fclose(input);
+
+  if ((dump.size() < FRAME_CAPTURE_HEADER_SIZE)      ||
+      (dump[0] != FRAME_CAPTURE_MAGIC_0)             ||
+      (dump[1] != FRAME_CAPTURE_MAGIC_1)             ||
+      (dump[2] != FRAME_CAPTURE_FORMAT_VERSION)        )
+  {
+    std::fprintf(stderr, "%s is not a version %u frame capture\n", argv[1], FRAME_CAPTURE_FORMAT_VERSION);
+    return (EXIT_FAILURE);
+  }
+
+  switch (resolution)
+  {
+    case 14UL: return (replay<RLSOrbis14BitTraits>(dump, static_cast<uint8_t>(deviceID)));
+    case 13UL: return (replay<RLSOrbis13BitTraits>(dump, static_cast<uint8_t>(deviceID)));
+    case 12UL: return (replay<RLSOrbis12BitTraits>(dump, static_cast<uint8_t>(deviceID)));
+
+    default:
+      std::fprintf(stderr, "resolution must be 14, 13 or 12 bits\n");
+      return (EXIT_FAILURE);
+  }
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,33 @@
+/**
+  ******************************************************************************
+  * @file    gpio.h
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host stand-in for the CubeMX generated GPIO header.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __hostGPIO_H
+#define __hostGPIO_H
+
+#include "stm32f4xx_hal.h"
+
+#endif /* __hostGPIO_H */
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,345 @@
+/**
+  ******************************************************************************
+  * @file    hostHAL.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the host stand-in HAL: peripheral instances, logged
+  *          GPIO and SPI DMA transfers completed on demand by the host tools.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "spi.h"
+
+/*************************************************************************************/
+/* PERIPHERAL INSTANCES                                                              */
+/*************************************************************************************/
+
+DWT_Type            hostDWT        = {};
+CoreDebug_Type      hostCoreDebug  = {};
+SPI_TypeDef         hostSPI1       = {};
+
+uint32_t            hostPRIMASK    = 0U;
+uint32_t            hostBASEPRI    = 0U;
+uint32_t            hostIPSR       = 0U;
+uint8_t             hostNVICPriority[HOST_EXCEPTION_COUNT] = {};
+
+static DMA_Stream_TypeDef hostSPI1TxStream = {};
+static DMA_Stream_TypeDef hostSPI1RxStream = {};
+static DMA_HandleTypeDef  hostSPI1TxDMA    = { .Instance = &hostSPI1TxStream, .Init = {}, .Parent = &hspi1,
+                                               .XferCpltCallback = NULL, .XferHalfCpltCallback = NULL, .XferErrorCallback = NULL };
+static DMA_HandleTypeDef  hostSPI1RxDMA    = { .Instance = &hostSPI1RxStream, .Init = {}, .Parent = &hspi1,
+                                               .XferCpltCallback = NULL, .XferHalfCpltCallback = NULL, .XferErrorCallback = NULL };
+
+/* As MX_SPI1_Init leaves it - master, 8-bit, mode 1 */
+SPI_HandleTypeDef   hspi1          = { .Instance = SPI1,
+                                       .Init     = { .Mode = 0U, .Direction = 0U, .DataSize = SPI_DATASIZE_8BIT,
+                                                     .CLKPolarity = SPI_POLARITY_LOW, .CLKPhase = SPI_PHASE_2EDGE,
+                                                     .NSS = 0U, .BaudRatePrescaler = SPI_BAUDRATEPRESCALER_16,
+                                                     .FirstBit = 0U, .TIMode = 0U, .CRCCalculation = 0U, .CRCPolynomial = 0U },
+                                       .hdmatx   = &hostSPI1TxDMA,
+                                       .hdmarx   = &hostSPI1RxDMA };
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+static const uint32_t     DMA_STREAM_EN   = (1UL << 0);
+static const uint32_t     DMA_STREAM_IT   = (1UL << 4);
+
+/*************************************************************************************/
+/* PRIVATE VARIABLES                                                                 */
+/*************************************************************************************/
+
+static SPI_HandleTypeDef* pendingHandle   = NULL;
+static HostSPIPending_t   pendingTransfer = { HOST_SPI_IDLE, NULL, NULL, 0U };
+
+static HostGPIOWrite_t    lastGPIOWrite   = { NULL, 0U, GPIO_PIN_SET };
+static uint32_t           GPIOWriteCount  = 0U;
+static bool               failDMAInit     = false;
+static uint32_t           assertCount     = 0U;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+static HAL_StatusTypeDef startDMA(DMA_HandleTypeDef* hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength, bool interrupts)
+{
+  if ((hdma->Instance->CR & DMA_STREAM_EN) != 0U)
+  {
+    return (HAL_BUSY);
+  }
+
+  hdma->Instance->M0AR = SrcAddress;
+  hdma->Instance->PAR  = DstAddress;
+  hdma->Instance->NDTR = DataLength;
+  hdma->Instance->CR   = DMA_STREAM_EN | (interrupts ? DMA_STREAM_IT : 0U) | hdma->Init.Mode;
+
+  return (HAL_OK);
+}
+
+
+static HAL_StatusTypeDef startTransfer(SPI_HandleTypeDef* hspi, HostSPITransfer_t kind, uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length)
+{
+  if ((pendingTransfer.kind != HOST_SPI_IDLE) || (length == 0U))
+  {
+    return (HAL_BUSY);
+  }
+
+  pendingHandle   = hspi;
+  pendingTransfer = { kind, txBuffer, rxBuffer, length };
+
+  hspi->hdmarx->Instance->NDTR = length;
+  hspi->Instance->CR1          = hspi->Instance->CR1 | SPI_CR1_SPE;
+
+  return (HAL_OK);
+}
+
+/*************************************************************************************/
+/* HAL FUNCTION DEFINITIONS                                                          */
+/*************************************************************************************/
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  lastGPIOWrite = { GPIOx, GPIO_Pin, PinState };
+  GPIOWriteCount++;
+}
+
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi)
+{
+  (void)hspi;
+  return (HAL_OK);
+}
+
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size)
+{
+  return (startTransfer(hspi, HOST_SPI_TRANSMIT_RECEIVE, pTxData, pRxData, Size));
+}
+
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size)
+{
+  return (startTransfer(hspi, HOST_SPI_TRANSMIT, pData, NULL, Size));
+}
+
+
+/* The Cube HAL runs a full-duplex master receive as a TransmitReceive of the rx buffer, but
+ * finishes it through HAL_SPI_RxCpltCallback - mirrored here */
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size)
+{
+  return (startTransfer(hspi, HOST_SPI_RECEIVE, pData, pData, Size));
+}
+
+
+HAL_StatusTypeDef HAL_SPI_DMAStop(SPI_HandleTypeDef* hspi)
+{
+  if (pendingHandle == hspi)
+  {
+    pendingTransfer = { HOST_SPI_IDLE, NULL, NULL, 0U };
+    pendingHandle   = NULL;
+  }
+
+  return (HAL_OK);
+}
+
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma)
+{
+  (void)hdma;
+
+  if (failDMAInit)
+  {
+    failDMAInit = false;
+    return (HAL_ERROR);
+  }
+
+  return (HAL_OK);
+}
+
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma)
+{
+  (void)hdma;
+  return (HAL_OK);
+}
+
+
+/* M0AR holds the source and PAR the destination whatever the direction - the host only reports them */
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef* hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+  return (startDMA(hdma, SrcAddress, DstAddress, DataLength, false));
+}
+
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+  return (startDMA(hdma, SrcAddress, DstAddress, DataLength, true));
+}
+
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma)
+{
+  hdma->Instance->CR = 0U;
+  return (HAL_OK);
+}
+
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel)
+{
+  (void)Channel;
+  htim->Instance->CR1 = htim->Instance->CR1 | 1U;
+  return (HAL_OK);
+}
+
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel)
+{
+  (void)Channel;
+  htim->Instance->CR1 = htim->Instance->CR1 & ~1U;
+  return (HAL_OK);
+}
+
+/* Weak no-ops as in the Cube HAL, so a callback the drivers do not define is silently dropped just as on target */
+__attribute__((weak)) void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi)     { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi)       { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi)       { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_TxRxHalfCpltCallback(SPI_HandleTypeDef* hspi) { (void)hspi; }
+
+/*************************************************************************************/
+/* HOST CONTROL FUNCTION DEFINITIONS                                                 */
+/*************************************************************************************/
+
+HostSPIPending_t hostHALPendingTransfer(SPI_HandleTypeDef* hspi)
+{
+  if (pendingHandle != hspi)
+  {
+    return { HOST_SPI_IDLE, NULL, NULL, 0U };
+  }
+
+  return (pendingTransfer);
+}
+
+
+bool hostHALCompleteTransfer(SPI_HandleTypeDef* hspi, const uint8_t* misoBytes)
+{
+  if ((pendingHandle != hspi) || (pendingTransfer.kind == HOST_SPI_IDLE))
+  {
+    return (false);
+  }
+
+  HostSPIPending_t transfer = pendingTransfer;
+
+  /* Lengths are in frames, as the HAL takes them */
+  uint32_t byteCount = transfer.length * ((hspi->Init.DataSize == SPI_DATASIZE_16BIT) ? 2U : 1U);
+
+  if (transfer.rxBuffer != NULL)
+  {
+    if (misoBytes != NULL) memcpy(transfer.rxBuffer, misoBytes, byteCount);
+    else                   memset(transfer.rxBuffer, 0, byteCount);
+  }
+
+  /* Idle before the callback, which may start the next transfer */
+  pendingTransfer              = { HOST_SPI_IDLE, NULL, NULL, 0U };
+  pendingHandle                = NULL;
+  hspi->hdmarx->Instance->NDTR = 0U;
+
+  switch (transfer.kind)
+  {
+    case HOST_SPI_TRANSMIT_RECEIVE: HAL_SPI_TxRxCpltCallback(hspi); break;
+    case HOST_SPI_TRANSMIT:         HAL_SPI_TxCpltCallback(hspi);   break;
+    case HOST_SPI_RECEIVE:          HAL_SPI_RxCpltCallback(hspi);   break;
+    default:                                                        break;
+  }
+
+  return (true);
+}
+
+
+HostDMAStream_t hostHALDMAStream(DMA_HandleTypeDef* hdma)
+{
+  HostDMAStream_t stream = { .running            = ((hdma->Instance->CR & DMA_STREAM_EN) != 0U),
+                             .interrupts         = ((hdma->Instance->CR & DMA_STREAM_IT) != 0U),
+                             .sourceAddress      = hdma->Instance->M0AR,
+                             .destinationAddress = hdma->Instance->PAR,
+                             .length             = hdma->Instance->NDTR };
+
+  return (stream);
+}
+
+
+bool hostHALDMAEvent(DMA_HandleTypeDef* hdma, bool halfTransfer)
+{
+  if ((hdma->Instance->CR & (DMA_STREAM_EN | DMA_STREAM_IT)) != (DMA_STREAM_EN | DMA_STREAM_IT))
+  {
+    return (false);
+  }
+
+  void (*callback)(DMA_HandleTypeDef*) = halfTransfer ? hdma->XferHalfCpltCallback : hdma->XferCpltCallback;
+
+  if (callback != NULL)
+  {
+    callback(hdma);
+  }
+
+  return (true);
+}
+
+
+#ifdef USE_FULL_ASSERT
+void assert_failed(uint8_t* file, uint32_t line)
+{
+  (void)file;
+  (void)line;
+
+  assertCount++;
+}
+#endif
+
+
+uint32_t hostHALAssertCount(void)
+{
+  return (assertCount);
+}
+
+
+void hostHALFailNextDMAInit(void)
+{
+  failDMAInit = true;
+}
+
+
+HostGPIOWrite_t hostHALLastGPIOWrite(void)
+{
+  return (lastGPIOWrite);
+}
+
+
+uint32_t hostHALGPIOWriteCount(void)
+{
+  return (GPIOWriteCount);
+}
+
+
+/**
+  * @}End of File
+  */
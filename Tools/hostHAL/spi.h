@@ -0,0 +1,35 @@
+/**
+  ******************************************************************************
+  * @file    spi.h
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host stand-in for the CubeMX generated SPI header.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __hostSPI_H
+#define __hostSPI_H
+
+#include "stm32f4xx_hal.h"
+
+extern SPI_HandleTypeDef hspi1;
+
+#endif /* __hostSPI_H */
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,336 @@
+/**
+  ******************************************************************************
+  * @file    stm32f4xx_hal.h
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host stand-in for the subset of the STM32F4 HAL the drivers use,
+  *          so the bus and encoder code can be built and exercised on a PC by
+  *          the host tools. Peripherals are plain structs, GPIO writes are
+  *          logged, and SPI DMA transfers stay pending until the tool
+  *          completes them with hostHALCompleteTransfer().
+  *
+  *          Only for host builds - put Tools/hostHAL on the include path in
+  *          place of the Cube HAL.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __hostHAL_H
+#define __hostHAL_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*************************************************************************************/
+/* PERIPHERAL TYPES                                                                  */
+/*************************************************************************************/
+
+#define __IO volatile
+
+typedef enum
+{
+  HAL_OK      = 0x00U,
+  HAL_ERROR   = 0x01U,
+  HAL_BUSY    = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  GPIO_PIN_RESET = 0U,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct { __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2]; } GPIO_TypeDef;
+typedef struct { __IO uint32_t CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR; } SPI_TypeDef;
+typedef struct { __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+typedef struct { __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR; } TIM_TypeDef;
+
+typedef struct
+{
+  uint32_t Channel, Direction, PeriphInc, MemInc, PeriphDataAlignment, MemDataAlignment, Mode, Priority, FIFOMode, FIFOThreshold, MemBurst, PeriphBurst;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+  DMA_Stream_TypeDef *Instance;
+  DMA_InitTypeDef     Init;
+  void               *Parent;
+  void              (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+  void              (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+  void              (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+  uint32_t Mode, Direction, DataSize, CLKPolarity, CLKPhase, NSS, BaudRatePrescaler, FirstBit, TIMode, CRCCalculation, CRCPolynomial;
+} SPI_InitTypeDef;
+
+typedef struct __SPI_HandleTypeDef
+{
+  SPI_TypeDef       *Instance;
+  SPI_InitTypeDef    Init;
+  DMA_HandleTypeDef *hdmatx;
+  DMA_HandleTypeDef *hdmarx;
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+  TIM_TypeDef       *Instance;
+  DMA_HandleTypeDef *hdma[7];
+} TIM_HandleTypeDef;
+
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+
+/*************************************************************************************/
+/* PERIPHERAL INSTANCES                                                              */
+/*************************************************************************************/
+
+extern DWT_Type       hostDWT;
+extern CoreDebug_Type hostCoreDebug;
+extern SPI_TypeDef    hostSPI1;
+
+#define DWT        (&hostDWT)
+#define CoreDebug  (&hostCoreDebug)
+#define SPI1       (&hostSPI1)
+
+/* Ports keep their target addresses - chip select IDs are derived from them, and the host GPIO never dereferences them */
+#define PERIPH_BASE      0x40000000UL
+#define AHB1PERIPH_BASE  (PERIPH_BASE + 0x00020000UL)
+#define GPIOA_BASE       (AHB1PERIPH_BASE + 0x0000UL)
+#define GPIOB_BASE       (AHB1PERIPH_BASE + 0x0400UL)
+#define GPIOC_BASE       (AHB1PERIPH_BASE + 0x0800UL)
+#define GPIOA            ((GPIO_TypeDef *) GPIOA_BASE)
+#define GPIOB            ((GPIO_TypeDef *) GPIOB_BASE)
+#define GPIOC            ((GPIO_TypeDef *) GPIOC_BASE)
+
+/*************************************************************************************/
+/* REGISTER AND HAL CONSTANTS                                                        */
+/*************************************************************************************/
+
+#define __NVIC_PRIO_BITS             4U
+
+/* CMSIS numbering - system exceptions are negative, an IRQ's exception number (as IPSR reports it) is IRQn + 16 */
+typedef enum
+{
+  SysTick_IRQn      = -1,
+  TIM2_IRQn         = 28,
+  SPI1_IRQn         = 35,
+  DMA2_Stream0_IRQn = 56
+} IRQn_Type;
+
+#define HOST_EXCEPTION_COUNT         (DMA2_Stream0_IRQn + 17)
+
+/* As the Cube's stm32f4xx_hal_conf.h has it - checked only in USE_FULL_ASSERT builds */
+#ifdef USE_FULL_ASSERT
+void assert_failed(uint8_t* file, uint32_t line);
+#define assert_param(expr)           ((expr) ? (void)0U : assert_failed((uint8_t*)__FILE__, __LINE__))
+#else
+#define assert_param(expr)           ((void)0U)
+#endif
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+
+#define GPIO_PIN_0                   ((uint16_t)0x0001)
+#define GPIO_PIN_1                   ((uint16_t)0x0002)
+#define GPIO_PIN_2                   ((uint16_t)0x0004)
+#define GPIO_PIN_3                   ((uint16_t)0x0008)
+#define GPIO_PIN_4                   ((uint16_t)0x0010)
+#define GPIO_PIN_5                   ((uint16_t)0x0020)
+#define GPIO_PIN_6                   ((uint16_t)0x0040)
+#define GPIO_PIN_7                   ((uint16_t)0x0080)
+
+#define SPI_CR1_CPHA                 (1UL << 0)
+#define SPI_CR1_CPOL                 (1UL << 1)
+#define SPI_CR1_BR                   (7UL << 3)
+#define SPI_CR1_SPE                  (1UL << 6)
+#define SPI_CR1_DFF                  (1UL << 11)
+#define SPI_CR2_RXDMAEN              (1UL << 0)
+#define SPI_CR2_TXDMAEN              (1UL << 1)
+#define SPI_FLAG_BSY                 (1UL << 7)
+
+#define SPI_BAUDRATEPRESCALER_2      0x00000000UL
+#define SPI_BAUDRATEPRESCALER_4      0x00000008UL
+#define SPI_BAUDRATEPRESCALER_8      0x00000010UL
+#define SPI_BAUDRATEPRESCALER_16     0x00000018UL
+#define SPI_BAUDRATEPRESCALER_32     0x00000020UL
+#define SPI_BAUDRATEPRESCALER_64     0x00000028UL
+#define SPI_BAUDRATEPRESCALER_128    0x00000030UL
+#define SPI_BAUDRATEPRESCALER_256    0x00000038UL
+#define SPI_POLARITY_LOW             0x00000000UL
+#define SPI_POLARITY_HIGH            SPI_CR1_CPOL
+#define SPI_PHASE_1EDGE              0x00000000UL
+#define SPI_PHASE_2EDGE              SPI_CR1_CPHA
+#define SPI_DATASIZE_8BIT            0x00000000UL
+#define SPI_DATASIZE_16BIT           SPI_CR1_DFF
+
+#define DMA_NORMAL                   0x00000000UL
+#define DMA_CIRCULAR                 (1UL << 8)
+#define DMA_PDATAALIGN_BYTE          0x00000000UL
+#define DMA_PDATAALIGN_HALFWORD      (1UL << 11)
+#define DMA_MDATAALIGN_BYTE          0x00000000UL
+#define DMA_MDATAALIGN_HALFWORD      (1UL << 13)
+
+#define TIM_CHANNEL_1                0x00000000UL
+#define TIM_CHANNEL_2                0x00000004UL
+#define TIM_CHANNEL_3                0x00000008UL
+#define TIM_CHANNEL_4                0x0000000CUL
+#define TIM_DMA_ID_CC1               ((uint16_t)0x0001)
+#define TIM_DMA_ID_CC2               ((uint16_t)0x0002)
+#define TIM_DMA_ID_CC3               ((uint16_t)0x0003)
+#define TIM_DMA_ID_CC4               ((uint16_t)0x0004)
+#define TIM_DMA_CC1                  (1UL << 9)
+#define TIM_DMA_CC2                  (1UL << 10)
+#define TIM_DMA_CC3                  (1UL << 11)
+#define TIM_DMA_CC4                  (1UL << 12)
+
+#define SET_BIT(REG, BIT)            ((REG) = (REG) | (BIT))
+#define CLEAR_BIT(REG, BIT)          ((REG) = (REG) & ~(BIT))
+
+#define __HAL_DMA_GET_COUNTER(h)     ((h)->Instance->NDTR)
+#define __HAL_SPI_DISABLE(h)         ((h)->Instance->CR1 = (h)->Instance->CR1 & ~SPI_CR1_SPE)
+#define __HAL_SPI_ENABLE(h)          ((h)->Instance->CR1 = (h)->Instance->CR1 | SPI_CR1_SPE)
+#define __HAL_SPI_GET_FLAG(h, f)     ((((h)->Instance->SR) & (f)) == (f))
+#define __HAL_SPI_CLEAR_OVRFLAG(h)   do { (void)(h)->Instance->DR; (void)(h)->Instance->SR; } while (0)
+#define __HAL_TIM_ENABLE_DMA(h, d)   ((h)->Instance->DIER = (h)->Instance->DIER | (d))
+#define __HAL_TIM_DISABLE_DMA(h, d)  ((h)->Instance->DIER = (h)->Instance->DIER & ~(d))
+
+/*************************************************************************************/
+/* CORE INTRINSICS                                                                   */
+/*************************************************************************************/
+
+/* One thread on the host - masking is bookkeeping only, and tools set IPSR to run code "in" an interrupt */
+extern uint32_t hostPRIMASK;
+extern uint32_t hostBASEPRI;
+extern uint32_t hostIPSR;
+extern uint8_t  hostNVICPriority[HOST_EXCEPTION_COUNT];
+
+static inline uint32_t __get_PRIMASK(void)           { return (hostPRIMASK); }
+static inline void     __set_PRIMASK(uint32_t mask)  { hostPRIMASK = mask; }
+static inline void     __disable_irq(void)           { hostPRIMASK = 1U; }
+static inline void     __enable_irq(void)            { hostPRIMASK = 0U; }
+static inline uint32_t __get_BASEPRI(void)           { return (hostBASEPRI); }
+static inline void     __set_BASEPRI(uint32_t mask)  { hostBASEPRI = mask; }
+static inline void     __set_BASEPRI_MAX(uint32_t mask)
+{
+  if ((mask != 0U) && ((hostBASEPRI == 0U) || (mask < hostBASEPRI))) hostBASEPRI = mask;
+}
+static inline uint32_t __get_IPSR(void)              { return (hostIPSR); }
+static inline void     __DMB(void)                   { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void     __DSB(void)                   { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void     __ISB(void)                   { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+/* Priorities are held unshifted, as NVIC_SetPriority takes them and NVIC_GetPriority returns them */
+static inline void     NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority) { hostNVICPriority[IRQn + 16] = (uint8_t)priority; }
+static inline uint32_t NVIC_GetPriority(IRQn_Type IRQn)                    { return (hostNVICPriority[IRQn + 16]); }
+
+/*************************************************************************************/
+/* HAL FUNCTIONS                                                                     */
+/*************************************************************************************/
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_DMAStop(SPI_HandleTypeDef* hspi);
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef* hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel);
+
+/* Weak in the Cube HAL - the drivers define the ones they use */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_TxRxHalfCpltCallback(SPI_HandleTypeDef* hspi);
+
+/*************************************************************************************/
+/* HOST CONTROL                                                                      */
+/*************************************************************************************/
+
+typedef enum
+{
+  HOST_SPI_IDLE = 0,
+  HOST_SPI_TRANSMIT_RECEIVE,
+  HOST_SPI_TRANSMIT,
+  HOST_SPI_RECEIVE
+} HostSPITransfer_t;
+
+typedef struct
+{
+  HostSPITransfer_t kind;
+  uint8_t*          txBuffer;
+  uint8_t*          rxBuffer;
+  uint16_t          length;
+} HostSPIPending_t;
+
+typedef struct
+{
+  GPIO_TypeDef* port;
+  uint16_t      pin;
+  GPIO_PinState state;
+} HostGPIOWrite_t;
+
+HostSPIPending_t hostHALPendingTransfer(SPI_HandleTypeDef* hspi);
+
+/* Finishes the pending transfer: clocks misoBytes (or zeros if NULL) into its rx buffer, then
+ * raises the completion callback the Cube HAL raises for that kind of transfer */
+bool hostHALCompleteTransfer(SPI_HandleTypeDef* hspi, const uint8_t* misoBytes);
+
+/* Addresses are truncated to the 32-bit HAL parameters, so host tools only compare them, never follow them */
+typedef struct
+{
+  bool     running;
+  bool     interrupts;
+  uint32_t sourceAddress;
+  uint32_t destinationAddress;
+  uint32_t length;
+} HostDMAStream_t;
+
+/* DMA streams keep their state in the stream's registers: CR bit 0 is EN, NDTR the length */
+HostDMAStream_t hostHALDMAStream(DMA_HandleTypeDef* hdma);
+
+/* Raises a running stream's half (or full) transfer callback, as a circular stream does at each half of its ring */
+bool hostHALDMAEvent(DMA_HandleTypeDef* hdma, bool halfTransfer);
+
+/* Failed assert_param checks so far - USE_FULL_ASSERT builds only */
+uint32_t hostHALAssertCount(void);
+
+/* Makes the next HAL_DMA_Init fail, as a stream left enabled does on the target */
+void hostHALFailNextDMAInit(void);
+
+HostGPIOWrite_t hostHALLastGPIOWrite(void);
+
+uint32_t hostHALGPIOWriteCount(void);
+
+#endif /* __hostHAL_H */
+
+/**
+  * @}End of File
+  */
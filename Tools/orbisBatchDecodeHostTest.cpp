@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    orbisBatchDecodeHostTest.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side test which runs the same Orbis frames through the batch
+  *          decoder and through the encoder driver's own decode path, and
+  *          checks position, CRC pass/fail and status agree frame for frame.
+  *          Frames are every payload with its correct CRC, every payload with
+  *          a corrupted CRC, and a spread of arbitrary 3-byte frames.
+  *
+  *          Usage: orbisBatchDecodeHostTest
+  *
+  *          Build with DeviceLayer/encoder.cpp, PeripheralLayer/STM32-SPIBus.cpp,
+  *          every Utilities source, Tools/hostHAL/hostHAL.cpp and -ITools/hostHAL.
+  *          Add -mavx2 or -mssse3 to check the vector path. Exits with
+  *          EXIT_FAILURE if any check fails.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../DeviceLayer/encoder.hpp"
+#include "../Utilities/frameCaptureFormat.hpp"
+#include "../Utilities/orbisBatchDecode.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+static_assert(ORBIS_BATCH_FRAME_SIZE     == RLSOrbis14BitTraits::FRAME_SIZE_IN_BYTES, "Batch frame size must match the driver");
+static_assert(ORBIS_BATCH_CRC_POLYNOMIAL == RLSOrbis14BitTraits::CRC_POLYNOMIAL,      "Batch CRC polynomial must match the driver");
+
+const uint32_t PAYLOAD_COUNT        = 65536U;
+const uint32_t ARBITRARY_FRAMES     = 65536U;
+const uint8_t  REPLAY_DEVICE_ID     = 0x04U;
+
+/* Only the first few mismatches are printed - one broken table fails every frame */
+const uint32_t MAX_REPORTED_FAILURES = 8U;
+
+/*************************************************************************************/
+/* REPLAY ENCODER                                                                    */
+/*************************************************************************************/
+
+/* Never fetches and has nothing attached, so replay only ever touches this instance */
+class ReplayEncoder:
+public SPIEncoder<RLSOrbis14BitTraits>
+{
+
+  public:
+
+  ReplayEncoder(void) : SPIEncoder<RLSOrbis14BitTraits>(REPLAY_DEVICE) {}
+
+  private:
+
+  static constexpr SPIDeviceDescriptor_t REPLAY_DEVICE = { .SPIBusID = SPI_BUS_1, .csPortAddress = GPIOA_BASE, .csPin = GPIO_PIN_4 };
+
+  virtual void positionFetchComplete(status_t positionFetchStatus) final
+  {
+    (void)positionFetchStatus;
+  }
+
+};
+
+/*************************************************************************************/
+/* PRIVATE VARIABLES                                                                 */
+/*************************************************************************************/
+
+static uint32_t failureCount = 0U;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+static void check(bool condition, const char* description, uint32_t frame)
+{
+  if (!condition)
+  {
+    if (failureCount < MAX_REPORTED_FAILURES)
+    {
+      std::fprintf(stderr, "FAIL: %s (frame %lu)\n", description, static_cast<unsigned long>(frame));
+    }
+
+    failureCount++;
+  }
+}
+
+
+static void appendFrame(std::vector<uint8_t>* frames, uint8_t byte0, uint8_t byte1, uint8_t CRC)
+{
+  frames->push_back(byte0);
+  frames->push_back(byte1);
+  frames->push_back(CRC);
+}
+
+
+/**
+  * @brief  Every payload with its correct CRC and with one bit of it flipped, then arbitrary frames
+  */
+static std::vector<uint8_t> buildFrames(void)
+{
+  static constexpr CRC8 ORBIS_CRC = CRC8(RLSOrbis14BitTraits::CRC_POLYNOMIAL);
+
+  std::vector<uint8_t> frames;
+
+  for (uint32_t payload = 0U; payload < PAYLOAD_COUNT; payload++)
+  {
+    uint8_t bytes[2] = { static_cast<uint8_t>(payload >> 8U), static_cast<uint8_t>(payload) };
+    uint8_t CRC      = ORBIS_CRC.calculateCRC8(bytes, 2U, RLSOrbis14BitTraits::CRC_INITIAL_VALUE) ^ RLSOrbis14BitTraits::CRC_FINAL_XOR;
+
+    appendFrame(&frames, bytes[0], bytes[1], CRC);
+    appendFrame(&frames, bytes[0], bytes[1], static_cast<uint8_t>(CRC ^ (1U << (payload & 7U))));
+  }
+
+  uint32_t state = 0x12345678U;
+
+  for (uint32_t frame = 0U; frame < ARBITRARY_FRAMES; frame++)
+  {
+    state = (state * 1664525U) + 1013904223U;
+
+    appendFrame(&frames, static_cast<uint8_t>(state >> 24U), static_cast<uint8_t>(state >> 16U), static_cast<uint8_t>(state >> 8U));
+  }
+
+  return (frames);
+}
+
+
+/**
+  * @brief  Replays one frame through the driver as a single-record capture
+  */
+static ReplayEncoder::ReplayStatistics_t replayFrame(ReplayEncoder* encoder, const uint8_t* frame)
+{
+  uint8_t capture[FRAME_CAPTURE_HEADER_SIZE + FRAME_CAPTURE_RECORD_HEADER_SIZE + ORBIS_BATCH_FRAME_SIZE] =
+  {
+    FRAME_CAPTURE_MAGIC_0, FRAME_CAPTURE_MAGIC_1, FRAME_CAPTURE_FORMAT_VERSION, 0U,
+    REPLAY_DEVICE_ID, ORBIS_BATCH_FRAME_SIZE, 0U, 0U, 0U, 0U,
+    frame[0], frame[1], frame[2]
+  };
+
+  return (encoder->replayCapture(capture, sizeof(capture), REPLAY_DEVICE_ID));
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(void)
+{
+  std::vector<uint8_t> frames     = buildFrames();
+  uint32_t             frameCount = static_cast<uint32_t>(frames.size() / ORBIS_BATCH_FRAME_SIZE);
+
+  std::vector<uint16_t> positions(frameCount);
+  std::vector<uint8_t>  statuses(frameCount);
+  std::vector<uint8_t>  CRCPass(frameCount);
+
+  OrbisBatchDecoder batchDecoder;
+  ReplayEncoder     encoder;
+
+  batchDecoder.decode(frames.data(), frameCount, positions.data(), statuses.data(), CRCPass.data());
+
+  for (uint32_t frame = 0U; frame < frameCount; frame++)
+  {
+    ReplayEncoder::ReplayStatistics_t replayStatistics = replayFrame(&encoder, &frames[frame * ORBIS_BATCH_FRAME_SIZE]);
+
+    bool statusOK = (statuses[frame] == RLSOrbis14BitTraits::STATUS_OK);
+
+    check(replayStatistics.frameCount == 1U,                                   "driver replayed the frame", frame);
+    check((replayStatistics.CRCFailCount == 1U) == (CRCPass[frame] == 0U),     "CRC pass/fail agrees",      frame);
+    check((replayStatistics.statusErrorCount == 1U) == ((CRCPass[frame] != 0U) && !statusOK),
+                                                                               "status agrees",             frame);
+
+    if (replayStatistics.validCount == 1U)
+    {
+      check(encoder.getLastRawPosition() == positions[frame],                  "position agrees",           frame);
+    }
+  }
+
+  if (failureCount > 0U)
+  {
+    std::fprintf(stderr, "%lu checks failed\n", static_cast<unsigned long>(failureCount));
+    return (EXIT_FAILURE);
+  }
+
+  std::fprintf(stderr, "all %lu frames agree (%s)\n", static_cast<unsigned long>(frameCount), OrbisBatchDecoder::getImplementationName());
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    orbisCalibrationFit.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side tool which fits an encoder linearity calibration blob
+  *          from a recording of raw positions taken at constant speed.
+  *
+  *          Usage: orbisCalibrationFit <positions.txt> <calibration.bin> [entriesLog2] [resolution]
+  *
+  *          The input holds one raw position per line, sampled at a fixed rate
+  *          over at least one full turn. The turn is unwrapped, a constant
+  *          speed line is fitted by least squares, and the residual error is
+  *          binned onto the table grid by position with linear weighting.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Utilities/calibrationFormat.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+const uint8_t DEFAULT_ENTRIES_LOG2 = 8U;
+const uint8_t DEFAULT_RESOLUTION   = 14U;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/**
+  * @brief  Unwraps raw positions into a continuous count, assuming less than half a turn per sample
+  */
+static std::vector<double> unwrapPositions(const std::vector<uint32_t>& positions, uint32_t countsPerTurn)
+{
+  std::vector<double> unwrapped(positions.size());
+
+  int64_t turnOffset = 0;
+
+  for (size_t index = 0U; index < positions.size(); index++)
+  {
+    if (index > 0U)
+    {
+      int64_t step = static_cast<int64_t>(positions[index]) - static_cast<int64_t>(positions[index - 1U]);
+
+      if (step >  static_cast<int64_t>(countsPerTurn / 2U)) turnOffset -= countsPerTurn;
+      if (step < -static_cast<int64_t>(countsPerTurn / 2U)) turnOffset += countsPerTurn;
+    }
+
+    unwrapped[index] = static_cast<double>(static_cast<int64_t>(positions[index]) + turnOffset);
+  }
+
+  return (unwrapped);
+}
+
+
+/**
+  * @brief  Fits the residual error of a constant speed recording onto the table grid
+  */
+static bool fitCorrections(const std::vector<uint32_t>& positions, uint8_t resolution, uint8_t entriesLog2,
+                           std::vector<int16_t>& corrections)
+{
+  uint32_t countsPerTurn   = 1UL << resolution;
+  uint32_t entryCount      = 1UL << entriesLog2;
+  double   countsPerEntry  = static_cast<double>(countsPerTurn) / entryCount;
+
+  std::vector<double> unwrapped = unwrapPositions(positions, countsPerTurn);
+
+  if (std::fabs(unwrapped.back() - unwrapped.front()) < countsPerTurn)
+  {
+    std::fprintf(stderr, "recording must cover at least one full turn\n");
+    return (false);
+  }
+
+  /* Least squares line through the unwrapped positions - the constant speed reference */
+  double n     = static_cast<double>(unwrapped.size());
+  double sumX  = 0.0;
+  double sumY  = 0.0;
+  double sumXX = 0.0;
+  double sumXY = 0.0;
+
+  for (size_t index = 0U; index < unwrapped.size(); index++)
+  {
+    double x = static_cast<double>(index);
+    sumX  += x;
+    sumY  += unwrapped[index];
+    sumXX += x * x;
+    sumXY += x * unwrapped[index];
+  }
+
+  double slope     = ((n * sumXY) - (sumX * sumY)) / ((n * sumXX) - (sumX * sumX));
+  double intercept = (sumY - (slope * sumX)) / n;
+
+  /* Spread each sample's correction over its two neighbouring grid points, matching the driver's interpolation */
+  std::vector<double> weightedSum(entryCount, 0.0);
+  std::vector<double> weightTotal(entryCount, 0.0);
+
+  for (size_t index = 0U; index < unwrapped.size(); index++)
+  {
+    double   correction = (intercept + (slope * static_cast<double>(index))) - unwrapped[index];
+    double   gridPoint  = static_cast<double>(positions[index]) / countsPerEntry;
+    uint32_t lower      = static_cast<uint32_t>(gridPoint) % entryCount;
+    uint32_t upper      = (lower + 1U) % entryCount;
+    double   weight     = gridPoint - std::floor(gridPoint);
+
+    weightedSum[lower] += (1.0 - weight) * correction;
+    weightTotal[lower] += (1.0 - weight);
+    weightedSum[upper] += weight * correction;
+    weightTotal[upper] += weight;
+  }
+
+  corrections.resize(entryCount);
+
+  for (uint32_t entry = 0U; entry < entryCount; entry++)
+  {
+    if (weightTotal[entry] <= 0.0)
+    {
+      std::fprintf(stderr, "no samples near table entry %u - record more data\n", entry);
+      return (false);
+    }
+
+    double scaled = std::round((weightedSum[entry] / weightTotal[entry]) * (1U << CALIBRATION_FRACTION_BITS));
+
+    if ((scaled > INT16_MAX) || (scaled < INT16_MIN))
+    {
+      std::fprintf(stderr, "correction at entry %u exceeds the table range\n", entry);
+      return (false);
+    }
+
+    corrections[entry] = static_cast<int16_t>(scaled);
+  }
+
+  return (true);
+}
+
+
+/**
+  * @brief  Serialises fitted corrections into the calibration blob format
+  */
+static std::vector<uint8_t> buildBlob(const std::vector<int16_t>& corrections, uint8_t resolution, uint8_t entriesLog2)
+{
+  std::vector<uint8_t> blob(CALIBRATION_HEADER_SIZE + (corrections.size() * CALIBRATION_ENTRY_SIZE), 0U);
+
+  blob[CALIBRATION_OFFSET_MAGIC_0]       = CALIBRATION_MAGIC_0;
+  blob[CALIBRATION_OFFSET_MAGIC_1]       = CALIBRATION_MAGIC_1;
+  blob[CALIBRATION_OFFSET_VERSION]       = CALIBRATION_FORMAT_VERSION;
+  blob[CALIBRATION_OFFSET_ENTRIES_LOG2]  = entriesLog2;
+  blob[CALIBRATION_OFFSET_RESOLUTION]    = resolution;
+  blob[CALIBRATION_OFFSET_FRACTION_BITS] = CALIBRATION_FRACTION_BITS;
+
+  for (size_t entry = 0U; entry < corrections.size(); entry++)
+  {
+    uint16_t raw = static_cast<uint16_t>(corrections[entry]);
+
+    blob[CALIBRATION_HEADER_SIZE + (entry * CALIBRATION_ENTRY_SIZE)]      = static_cast<uint8_t>(raw & 0xFFU);
+    blob[CALIBRATION_HEADER_SIZE + (entry * CALIBRATION_ENTRY_SIZE) + 1U] = static_cast<uint8_t>(raw >> 8U);
+  }
+
+  uint16_t checksum = calibrationChecksum(&blob[CALIBRATION_HEADER_SIZE], blob.size() - CALIBRATION_HEADER_SIZE);
+
+  blob[CALIBRATION_OFFSET_CHECKSUM]      = static_cast<uint8_t>(checksum & 0xFFU);
+  blob[CALIBRATION_OFFSET_CHECKSUM + 1U] = static_cast<uint8_t>(checksum >> 8U);
+
+  return (blob);
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::fprintf(stderr, "usage: %s <positions.txt> <calibration.bin> [entriesLog2] [resolution]\n", argv[0]);
+    return (EXIT_FAILURE);
+  }
+
+  uint8_t entriesLog2 = (argc > 3) ? static_cast<uint8_t>(std::atoi(argv[3])) : DEFAULT_ENTRIES_LOG2;
+  uint8_t resolution  = (argc > 4) ? static_cast<uint8_t>(std::atoi(argv[4])) : DEFAULT_RESOLUTION;
+
+  if ((entriesLog2 < CALIBRATION_MIN_ENTRIES_LOG2) ||
+      (entriesLog2 > CALIBRATION_MAX_ENTRIES_LOG2) ||
+      (entriesLog2 > resolution)                   ||
+      (resolution  > 16U)                            )
+  {
+    std::fprintf(stderr, "unsupported table size or resolution\n");
+    return (EXIT_FAILURE);
+  }
+
+  FILE* input = std::fopen(argv[1], "r");
+
+  if (input == NULL)
+  {
+    std::perror(argv[1]);
+    return (EXIT_FAILURE);
+  }
+
+  std::vector<uint32_t> positions;
+  unsigned long         position;
+
+  while (std::fscanf(input, "%lu", &position) == 1)
+  {
+    positions.push_back(static_cast<uint32_t>(position) & ((1UL << resolution) - 1U));
+  }
+
+  std::fclose(input);
+
+  std::vector<int16_t> corrections;
+
+  if ((positions.size() < 2U) || !fitCorrections(positions, resolution, entriesLog2, corrections))
+  {
+    return (EXIT_FAILURE);
+  }
+
+  std::vector<uint8_t> blob = buildBlob(corrections, resolution, entriesLog2);
+
+  FILE* output = std::fopen(argv[2], "wb");
+
+  if (output == NULL)
+  {
+    std::perror(argv[2]);
+    return (EXIT_FAILURE);
+  }
+
+  /* fclose flushes the tail of the blob, so its result counts as much as the write's */
+  bool written = (std::fwrite(blob.data(), 1U, blob.size(), output) == blob.size());
+  bool closed  = (std::fclose(output) == 0);
+
+  if (!written || !closed)
+  {
+    std::perror(argv[2]);
+    return (EXIT_FAILURE);
+  }
+
+  std::printf("wrote %zu entries (%zu bytes) to %s\n", corrections.size(), blob.size(), argv[2]);
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,893 @@
+/**
+  ******************************************************************************
+  * @file    spiBusHostTest.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side test which runs SPI bus jobs through the real bus driver
+  *          on the host stand-in HAL, completing each DMA transfer through the
+  *          callback the Cube HAL raises for it, and checks every job retires
+  *          and the queue keeps moving - pipelined, chained, and reordered to
+  *          group devices by their settings. Also checks a stream is paced by
+  *          its trigger timer's DMA request and starts with the device's
+  *          settings, and that a task awaiting a transfer on a full queue is
+  *          resumed.
+  *          A stress case interleaves submissions from thread mode and from
+  *          completion callbacks with completions, and checks jobs retire in
+  *          order. Reports the driver's job throughput in MB/s across job
+  *          sizes.
+  *
+  *          Usage: spiBusHostTest
+  *
+  *          Build with PeripheralLayer/STM32-SPIBus.cpp, PeripheralLayer/STM32-SPIAsync.cpp,
+  *          Utilities/frameCapture.cpp, Utilities/coroutineTask.cpp, Utilities/utilities.cpp,
+  *          Tools/hostHAL/hostHAL.cpp and -ITools/hostHAL. Add -DUSE_FULL_ASSERT to
+  *          check submitters above the bus priority are caught.
+  *          Exits with EXIT_FAILURE if any check fails.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "spi.h"
+#include "../PeripheralLayer/STM32-SPIBus.hpp"
+#include "../PeripheralLayer/STM32-SPIAsync.hpp"
+#include "../PeripheralLayer/SPITopology.hpp"
+#include "../Utilities/frameCapture.hpp"
+
+/*************************************************************************************/
+/* TEST DEVICE                                                                       */
+/*************************************************************************************/
+
+class TestDevice:
+public SPI
+{
+
+  public:
+
+  uint32_t completeCount       = 0U;
+  uint32_t errorCount          = 0U;
+  uint32_t streamHalfCount     = 0U;
+  uint32_t streamCompleteCount = 0U;
+  uint32_t queuedTimestamps[4] = {0U};
+
+  /* What the bus had on the wire as each callback ran */
+  HostSPIPending_t pendingAtComplete[4] = {};
+
+  TestDevice(void) {}
+
+  TestDevice(SPIBusConfig_t busConfig) : SPI(busConfig) {}
+
+  status_t queue(uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length)
+  {
+    return (queueChained(txBuffer, rxBuffer, length, NULL, 0U));
+  }
+
+  status_t queueChained(uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t length, const SPISegment_t* chainedSegments, uint8_t chainedSegmentCount)
+  {
+    SPIJob_t SPIJob = { .SPIObject           = getObjectContext(),
+                        .SPIBusID            = SPI_BUS_1,
+                        .csPort              = GPIOA,
+                        .csPin               = GPIO_PIN_4,
+                        .txBuffer            = txBuffer,
+                        .rxBuffer            = rxBuffer,
+                        .length              = length,
+                        .chainedSegments     = chainedSegments,
+                        .chainedSegmentCount = chainedSegmentCount,
+                        .queuedTimestamp     = 0U
+                      };
+
+    return (transmitReceiveAsync(SPIJob));
+  }
+
+  status_t stream(TIM_HandleTypeDef* triggerTimer, uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t frameLength, uint16_t frameCount)
+  {
+    SPIStream_t SPIStream = { .SPIObject      = getObjectContext(),
+                              .SPIBusID       = SPI_BUS_1,
+                              .triggerTimer   = triggerTimer,
+                              .triggerChannel = TIM_CHANNEL_1,
+                              .txBuffer       = txBuffer,
+                              .rxBuffer       = rxBuffer,
+                              .frameLength    = frameLength,
+                              .frameCount     = frameCount
+                            };
+
+    return (startStream(SPIStream));
+  }
+
+  private:
+
+  virtual void transmitReceiveComplete(void) final
+  {
+    if (completeCount < 4U)
+    {
+      queuedTimestamps[completeCount]  = getQueuedTimestamp();
+      pendingAtComplete[completeCount] = hostHALPendingTransfer(&hspi1);
+    }
+
+    completeCount++;
+  }
+
+  virtual void transferError(void) final
+  {
+    errorCount++;
+  }
+
+  virtual void streamHalfComplete(void) final
+  {
+    streamHalfCount++;
+  }
+
+  virtual void streamComplete(void) final
+  {
+    streamCompleteCount++;
+  }
+
+};
+
+/* Numbers its jobs, and checks each retires in order with the byte clocked in for it */
+class StressDevice:
+public SPI
+{
+
+  public:
+
+  static const uint8_t JOB_RING_SIZE = 64U;
+
+  uint32_t submittedCount  = 0U;
+  uint32_t completedCount  = 0U;
+  uint32_t unexpectedCount = 0U;
+  uint32_t resubmitBudget  = 0U;
+
+  status_t submit(void)
+  {
+    uint8_t slot = static_cast<uint8_t>(submittedCount % JOB_RING_SIZE);
+
+    _txBytes[slot] = static_cast<uint8_t>(submittedCount);
+    _rxBytes[slot] = 0U;
+
+    SPIJob_t SPIJob = { .SPIObject           = getObjectContext(),
+                        .SPIBusID            = SPI_BUS_1,
+                        .csPort              = GPIOA,
+                        .csPin               = GPIO_PIN_4,
+                        .txBuffer            = &_txBytes[slot],
+                        .rxBuffer            = &_rxBytes[slot],
+                        .length              = 1U,
+                        .chainedSegments     = NULL,
+                        .chainedSegmentCount = 0U,
+                        .queuedTimestamp     = 0U
+                      };
+
+    status_t submitStatus = transmitReceiveAsync(SPIJob);
+
+    if (submitStatus == STATUS_OK)
+    {
+      submittedCount++;
+    }
+    else if ((submittedCount - completedCount) < static_cast<uint32_t>(SPI_JOB_QUEUE_SIZE))
+    {
+      /* Only a full queue may refuse a job */
+      unexpectedCount++;
+    }
+
+    return (submitStatus);
+  }
+
+  private:
+
+  uint8_t _txBytes[JOB_RING_SIZE] = {0U};
+  uint8_t _rxBytes[JOB_RING_SIZE] = {0U};
+
+  /* The test clocks in the inverse of each job's tx byte */
+  virtual void transmitReceiveComplete(void) final
+  {
+    uint8_t slot = static_cast<uint8_t>(completedCount % JOB_RING_SIZE);
+
+    if ((_txBytes[slot] != static_cast<uint8_t>(completedCount)) ||
+        (_rxBytes[slot] != static_cast<uint8_t>(~_txBytes[slot]))  )
+    {
+      unexpectedCount++;
+    }
+
+    completedCount++;
+
+    if (resubmitBudget > 0U)
+    {
+      resubmitBudget--;
+      (void)submit();
+    }
+  }
+
+  virtual void transferError(void) final
+  {
+    unexpectedCount++;
+  }
+
+  virtual void streamHalfComplete(void) final {}
+
+  virtual void streamComplete(void) final {}
+
+};
+
+/*************************************************************************************/
+/* PRIVATE VARIABLES                                                                 */
+/*************************************************************************************/
+
+static uint32_t failureCount = 0U;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+static void check(bool condition, const char* description)
+{
+  if (!condition)
+  {
+    std::fprintf(stderr, "FAIL: %s\n", description);
+    failureCount++;
+  }
+}
+
+
+static uint32_t hostAddress(const volatile void* address)
+{
+  return (static_cast<uint32_t>(reinterpret_cast<uintptr_t>(address)));
+}
+
+
+static bool chipSelectReleased(void)
+{
+  HostGPIOWrite_t lastWrite = hostHALLastGPIOWrite();
+
+  return ((lastWrite.port == GPIOA) && (lastWrite.pin == GPIO_PIN_4) && (lastWrite.state == GPIO_PIN_SET));
+}
+
+
+/* A receive-only job completes through HAL_SPI_RxCpltCallback, and must retire like any other */
+static void testReceiveOnlyJob(void)
+{
+  TestDevice    device;
+  uint8_t       rxBuffer[3]  = {0U};
+  const uint8_t misoBytes[3] = {0x12U, 0x34U, 0x56U};
+
+  check(device.queue(NULL, rxBuffer, sizeof(rxBuffer)) == STATUS_OK, "receive-only job is accepted");
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_RECEIVE, "receive-only job starts as an rx DMA transfer");
+
+  check(hostHALCompleteTransfer(&hspi1, misoBytes), "receive-only transfer completes");
+  check(device.completeCount == 1U, "receive-only job reaches transmitReceiveComplete");
+  check(std::memcmp(rxBuffer, misoBytes, sizeof(rxBuffer)) == 0, "receive-only job delivers the clocked-in bytes");
+  check(chipSelectReleased(), "receive-only job releases chip select");
+
+  /* The queue must still be live - the next job starts at once and retires too */
+  uint8_t txBuffer[2] = {0xA5U, 0x5AU};
+
+  check(device.queue(txBuffer, rxBuffer, sizeof(txBuffer)) == STATUS_OK, "job after a receive-only job is accepted");
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_TRANSMIT_RECEIVE, "job after a receive-only job starts");
+  check(hostHALCompleteTransfer(&hspi1, NULL), "job after a receive-only job completes");
+  check(device.completeCount == 2U, "job after a receive-only job retires");
+}
+
+
+/* Receive-only jobs queued behind each other must each start as the previous one retires */
+static void testQueuedReceiveOnlyJobs(void)
+{
+  TestDevice device;
+  uint8_t    rxBuffers[3][2] = {{0U}};
+  uint8_t    txBuffer[2]     = {0xFFU, 0xFFU};
+
+  /* Hold the bus with a full-duplex job so the receive-only jobs queue up */
+  check(device.queue(txBuffer, rxBuffers[0], 2U) == STATUS_OK, "leading job is accepted");
+  check(device.queue(NULL, rxBuffers[1], 2U) == STATUS_OK, "first queued receive-only job is accepted");
+  check(device.queue(NULL, rxBuffers[2], 2U) == STATUS_OK, "second queued receive-only job is accepted");
+
+  for (uint8_t job = 0U; job < 3U; job++)
+  {
+    check(hostHALPendingTransfer(&hspi1).kind != HOST_SPI_IDLE, "queued job is started");
+    hostHALCompleteTransfer(&hspi1, NULL);
+  }
+
+  check(device.completeCount == 3U, "every queued job retires");
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_IDLE, "bus is idle once the queue drains");
+  check(chipSelectReleased(), "chip select is released once the queue drains");
+}
+
+
+/* Transmit-only jobs complete through HAL_SPI_TxCpltCallback */
+static void testTransmitOnlyJob(void)
+{
+  TestDevice device;
+  uint8_t    txBuffer[4] = {1U, 2U, 3U, 4U};
+
+  check(device.queue(txBuffer, NULL, sizeof(txBuffer)) == STATUS_OK, "transmit-only job is accepted");
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_TRANSMIT, "transmit-only job starts as a tx DMA transfer");
+  check(hostHALCompleteTransfer(&hspi1, NULL), "transmit-only transfer completes");
+  check(device.completeCount == 1U, "transmit-only job retires");
+  check(chipSelectReleased(), "transmit-only job releases chip select");
+}
+
+/* Each job carries the cycle count it was queued at, so jobs queued behind each other keep their own */
+static void testQueuedTimestampPerJob(void)
+{
+  TestDevice device;
+  uint8_t    txBuffer[2] = {0U};
+
+  hostDWT.CYCCNT = 1000U;
+  check(device.queue(txBuffer, NULL, 2U) == STATUS_OK, "first timestamped job is accepted");
+
+  hostDWT.CYCCNT = 2000U;
+  check(device.queue(txBuffer, NULL, 2U) == STATUS_OK, "second timestamped job is accepted");
+
+  hostDWT.CYCCNT = 3000U;
+  hostHALCompleteTransfer(&hspi1, NULL);
+  hostHALCompleteTransfer(&hspi1, NULL);
+
+  check(device.completeCount == 2U,              "both timestamped jobs retire");
+  check(device.queuedTimestamps[0] == 1000U,     "first job reports its own queue time");
+  check(device.queuedTimestamps[1] == 2000U,     "second job reports its own queue time");
+}
+
+
+/* Awaits one transfer and records how it finished */
+static Task awaitTransfer(AsyncSPIBus* bus, uint8_t* txBuffer, status_t* transferStatus, bool* resumed)
+{
+  *transferStatus = co_await bus->transfer(GPIOA, GPIO_PIN_5, txBuffer, NULL, 1U);
+  *resumed        = true;
+
+  co_return (STATUS_OK);
+}
+
+
+/* A job refused by a full queue must be reported, or an awaiting task parks on it for good */
+static void testAwaitOnFullQueue(void)
+{
+  TestDevice          device;
+  AsyncSPIBus         bus(SPI_BUS_1);
+  CooperativeExecutor executor;
+  uint8_t             txBuffer[1]    = {0U};
+  status_t            transferStatus = STATUS_OK;
+  bool                resumed        = false;
+  uint8_t             freeFrames     = CoroutineFramePool::getFreeFrameCount();
+  bool                allAccepted    = true;
+
+  for (int8_t job = 0; job < SPI_JOB_QUEUE_SIZE; job++)
+  {
+    allAccepted = allAccepted && (device.queue(txBuffer, NULL, 1U) == STATUS_OK);
+  }
+
+  check(allAccepted, "jobs up to the queue size are accepted");
+  check(device.queue(txBuffer, NULL, 1U) == STATUS_ERROR, "job beyond a full queue is refused");
+  check(hostBASEPRI == 0U, "refused job leaves the bus critical section");
+
+  check(executor.spawn(awaitTransfer(&bus, txBuffer, &transferStatus, &resumed)) == STATUS_OK, "awaiting task is spawned");
+  executor.runReady();
+
+  check(resumed, "task awaiting a transfer on a full queue is resumed");
+  check(transferStatus == STATUS_ERROR, "transfer refused by a full queue yields STATUS_ERROR");
+  check(CoroutineFramePool::getFreeFrameCount() == freeFrames, "resumed task's frame is released");
+
+  while (hostHALCompleteTransfer(&hspi1, NULL)) {}
+
+  check(device.completeCount == static_cast<uint32_t>(SPI_JOB_QUEUE_SIZE), "every accepted job retires");
+}
+
+
+/* The next job goes on the wire before the finished job's callback runs, so the callback overlaps it */
+static void testPipelinedCompletion(void)
+{
+  TestDevice device;
+  uint8_t    txBuffer[2]     = {0U};
+  uint8_t    rxBuffers[2][2] = {{0U}};
+
+  check(device.queue(txBuffer, rxBuffers[0], 2U) == STATUS_OK, "first pipelined job is accepted");
+  check(device.queue(txBuffer, rxBuffers[1], 2U) == STATUS_OK, "second pipelined job is accepted");
+
+  check(hostHALCompleteTransfer(&hspi1, NULL), "first pipelined job completes");
+  check(device.completeCount == 1U, "first pipelined job retires");
+  check(device.pendingAtComplete[0].kind == HOST_SPI_TRANSMIT_RECEIVE, "next job is on the wire as the callback runs");
+  check(device.pendingAtComplete[0].rxBuffer == rxBuffers[1],           "job on the wire is the next one queued");
+
+  check(hostHALCompleteTransfer(&hspi1, NULL), "second pipelined job completes");
+  check(device.completeCount == 2U, "second pipelined job retires");
+  check(device.pendingAtComplete[1].kind == HOST_SPI_IDLE, "bus is idle as the last job's callback runs");
+  check(chipSelectReleased(), "chip select is released after the pipelined jobs");
+}
+
+
+/* A job reusing the rx buffer of the job before must wait for its callback, or DMA would overwrite what it reads */
+static void testSharedRxBufferNotPipelined(void)
+{
+  TestDevice    device;
+  uint8_t       txBuffer[2]  = {0U};
+  uint8_t       rxBuffer[2]  = {0U};
+  const uint8_t misoBytes[2] = {0xC3U, 0x3CU};
+
+  check(device.queue(txBuffer, rxBuffer, 2U) == STATUS_OK, "first job on a shared rx buffer is accepted");
+  check(device.queue(txBuffer, rxBuffer, 2U) == STATUS_OK, "second job on a shared rx buffer is accepted");
+
+  check(hostHALCompleteTransfer(&hspi1, misoBytes), "first job on a shared rx buffer completes");
+  check(device.completeCount == 1U, "first job on a shared rx buffer retires");
+  check(device.pendingAtComplete[0].kind == HOST_SPI_IDLE, "job sharing the rx buffer is held back during the callback");
+  check(std::memcmp(rxBuffer, misoBytes, sizeof(rxBuffer)) == 0, "callback reads its own job's bytes");
+
+  check(hostHALPendingTransfer(&hspi1).rxBuffer == rxBuffer, "job sharing the rx buffer starts once the callback returns");
+  check(hostHALCompleteTransfer(&hspi1, NULL) && (device.completeCount == 2U), "job sharing the rx buffer retires");
+}
+
+
+/* Chained segments run in order under one chip select, and the job only completes after the last */
+static void testChainedSegments(void)
+{
+  TestDevice    device;
+  uint8_t       command[1]   = {0x03U};
+  uint8_t       address[3]   = {0x00U, 0x10U, 0x00U};
+  uint8_t       data[8]      = {0U};
+  uint8_t       trailer[2]   = {0xFFU, 0xFFU};
+  uint8_t       otherTx[1]   = {0U};
+  const uint8_t misoBytes[8] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+
+  const SPI::SPISegment_t segments[3] = { { .txBuffer = address, .rxBuffer = NULL, .length = sizeof(address) },
+                                          { .txBuffer = NULL,    .rxBuffer = data, .length = sizeof(data)    },
+                                          { .txBuffer = trailer, .rxBuffer = NULL, .length = sizeof(trailer) } };
+
+  check(device.queueChained(command, NULL, sizeof(command), segments, 3U) == STATUS_OK, "chained job is accepted");
+  check(device.queue(otherTx, NULL, sizeof(otherTx)) == STATUS_OK, "job behind a chained job is accepted");
+
+  uint32_t gpioWrites = hostHALGPIOWriteCount();
+
+  check(hostHALPendingTransfer(&hspi1).txBuffer == command, "chained job starts with its own buffers");
+  check(hostHALCompleteTransfer(&hspi1, NULL), "first segment completes");
+
+  HostSPIPending_t pending = hostHALPendingTransfer(&hspi1);
+
+  check((pending.kind == HOST_SPI_TRANSMIT) && (pending.txBuffer == address) && (pending.length == sizeof(address)),
+        "first chained segment follows");
+
+  check(hostHALCompleteTransfer(&hspi1, NULL), "first chained segment completes");
+
+  pending = hostHALPendingTransfer(&hspi1);
+
+  check((pending.kind == HOST_SPI_RECEIVE) && (pending.rxBuffer == data) && (pending.length == sizeof(data)),
+        "rx-only chained segment follows");
+
+  check(hostHALCompleteTransfer(&hspi1, misoBytes), "rx-only chained segment completes");
+  check(std::memcmp(data, misoBytes, sizeof(data)) == 0, "rx-only chained segment delivers its bytes");
+
+  pending = hostHALPendingTransfer(&hspi1);
+
+  check((pending.kind == HOST_SPI_TRANSMIT) && (pending.txBuffer == trailer), "last chained segment follows");
+  check(device.completeCount == 0U, "chained job does not complete between segments");
+  check(hostHALGPIOWriteCount() == gpioWrites, "chip select is held between segments");
+
+  check(hostHALCompleteTransfer(&hspi1, NULL), "last chained segment completes");
+  check(device.completeCount == 1U, "chained job completes after its last segment");
+  check(device.pendingAtComplete[0].txBuffer == otherTx, "job behind the chain starts once the chain finishes");
+
+  check(hostHALCompleteTransfer(&hspi1, NULL) && (device.completeCount == 2U), "job behind a chained job retires");
+  check(chipSelectReleased(), "chip select is released after the chained job");
+}
+
+
+/* SPI_MAX_GROUPED_JOB_RUN in STM32-SPIBus.cpp */
+const uint8_t GROUPED_JOB_RUN_LIMIT = 8U;
+
+/* Completes the pending transfer, noting the tag in its tx buffer's first byte */
+static bool completeAndTag(std::vector<uint8_t>* retiredTags)
+{
+  HostSPIPending_t pending = hostHALPendingTransfer(&hspi1);
+
+  if (pending.kind == HOST_SPI_IDLE)
+  {
+    return (false);
+  }
+
+  retiredTags->push_back(pending.txBuffer[0]);
+
+  return (hostHALCompleteTransfer(&hspi1, NULL));
+}
+
+
+/* Grouping by config serves jobs matching the bus's settings first, but never past the run limit */
+static void testGroupByConfigReordering(void)
+{
+  const SPI::SPIBusConfig_t fastConfig = { .baudRatePrescaler = SPI_BAUDRATEPRESCALER_2,
+                                           .clockPolarity     = SPI_POLARITY_HIGH,
+                                           .clockPhase        = SPI_PHASE_1EDGE,
+                                           .dataSize          = SPI_DATASIZE_8BIT };
+
+  /* Tags 0x0n are default devices' jobs, 0xFn the fast device's */
+  TestDevice           defaultDevice;
+  TestDevice           fastDevice(fastConfig);
+  uint8_t              defaultTags[12];
+  uint8_t              fastTags[2]   = {0xF0U, 0xF1U};
+  std::vector<uint8_t> retiredTags;
+
+  for (uint8_t tag = 0U; tag < 12U; tag++)
+  {
+    defaultTags[tag] = tag;
+  }
+
+  SPI::setBusSchedulingPolicy(SPI_BUS_1, SPI_SCHEDULE_GROUP_BY_CONFIG);
+
+  /* Default, fast, default, fast, default - grouping runs the defaults together */
+
+  check(defaultDevice.queue(&defaultTags[0], NULL, 1U) == STATUS_OK, "first grouped job is accepted");
+  check(fastDevice.queue(&fastTags[0], NULL, 1U)       == STATUS_OK, "first fast job is accepted");
+  check(defaultDevice.queue(&defaultTags[1], NULL, 1U) == STATUS_OK, "second grouped job is accepted");
+  check(fastDevice.queue(&fastTags[1], NULL, 1U)       == STATUS_OK, "second fast job is accepted");
+  check(defaultDevice.queue(&defaultTags[2], NULL, 1U) == STATUS_OK, "third grouped job is accepted");
+
+  while (completeAndTag(&retiredTags)) {}
+
+  const uint8_t groupedOrder[5] = {0x00U, 0x01U, 0x02U, 0xF0U, 0xF1U};
+
+  check((retiredTags.size() == 5U) && (std::memcmp(retiredTags.data(), groupedOrder, 5U) == 0),
+        "jobs matching the bus's settings are served first");
+
+  /* One fast job behind a long run of default jobs waits for at most the run limit */
+  retiredTags.clear();
+
+  check(defaultDevice.queue(&defaultTags[0], NULL, 1U) == STATUS_OK, "leading default job is accepted");
+  check(fastDevice.queue(&fastTags[0], NULL, 1U)       == STATUS_OK, "starved fast job is accepted");
+
+  for (uint8_t tag = 1U; tag < 12U; tag++)
+  {
+    (void)defaultDevice.queue(&defaultTags[tag], NULL, 1U);
+  }
+
+  while (completeAndTag(&retiredTags)) {}
+
+  check(retiredTags.size() == 13U, "every grouped job retires");
+  check((retiredTags.size() > (GROUPED_JOB_RUN_LIMIT + 1U)) && (retiredTags[GROUPED_JOB_RUN_LIMIT + 1U] == 0xF0U),
+        "fast job is served once the run limit is reached");
+
+  SPI::setBusSchedulingPolicy(SPI_BUS_1, SPI_SCHEDULE_FIFO);
+
+  check(defaultDevice.queue(&defaultTags[0], NULL, 1U) == STATUS_OK, "job after grouping is accepted");
+  check((SPI1->CR1 & SPI_CR1_BR) == SPI_BAUDRATEPRESCALER_16, "default device gets the CubeMX prescaler back");
+  check(hostHALCompleteTransfer(&hspi1, NULL), "job after grouping retires");
+}
+
+
+/* Job lengths are in frames, so a 16-bit device's capture record holds two bytes per frame */
+static void testCaptureOfWideFrames(void)
+{
+  const SPI::SPIBusConfig_t wideConfig = { .baudRatePrescaler = SPI_BAUDRATEPRESCALER_16,
+                                           .clockPolarity     = SPI_POLARITY_LOW,
+                                           .clockPhase        = SPI_PHASE_2EDGE,
+                                           .dataSize          = SPI_DATASIZE_16BIT };
+
+  TestDevice           wideDevice(wideConfig);
+  FrameCaptureRecord_t records[2]   = {};
+  FrameCapture         capture(records, 2U);
+  uint8_t              rxBuffer[6]  = {0U};
+  const uint8_t        misoBytes[6] = {0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U};
+
+  SPI::setBusCapture(SPI_BUS_1, &capture);
+
+  check(wideDevice.queue(NULL, rxBuffer, 3U) == STATUS_OK, "16-bit job is accepted");
+  check(hostHALCompleteTransfer(&hspi1, misoBytes) && (wideDevice.completeCount == 1U), "16-bit job retires");
+
+  SPI::setBusCapture(SPI_BUS_1, NULL);
+
+  check(records[0].length == sizeof(misoBytes), "16-bit job is captured as two bytes per frame");
+  check(std::memcmp(records[0].frame, misoBytes, sizeof(misoBytes)) == 0, "16-bit capture holds every byte received");
+}
+
+
+/* A failed DMA init leaves the handle holding the failed device's settings - the CubeMX defaults must survive it */
+static void testFailedDMAInitKeepsDefaults(void)
+{
+  const SPI::SPIBusConfig_t wideConfig = { .baudRatePrescaler = SPI_BAUDRATEPRESCALER_8,
+                                           .clockPolarity     = SPI_POLARITY_LOW,
+                                           .clockPhase        = SPI_PHASE_1EDGE,
+                                           .dataSize          = SPI_DATASIZE_16BIT };
+
+  TestDevice wideDevice(wideConfig);
+  TestDevice defaultDevice;
+  uint8_t    txBuffer[2] = {0U};
+
+  /* Start from the CubeMX settings, so the wide device needs its DMA streams set up again */
+  check(defaultDevice.queue(txBuffer, NULL, 1U) == STATUS_OK, "job before a failed DMA init is accepted");
+  check(hostHALCompleteTransfer(&hspi1, NULL), "job before a failed DMA init retires");
+
+  hostHALFailNextDMAInit();
+
+  check(wideDevice.queue(txBuffer, NULL, 1U) == STATUS_OK, "job with a failing DMA init is accepted");
+  check(wideDevice.errorCount == 1U, "failed DMA init fails the job");
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_IDLE, "failed job is not started");
+
+  check(defaultDevice.queue(txBuffer, NULL, 1U) == STATUS_OK, "job after a failed DMA init is accepted");
+  check((SPI1->CR1 & SPI_CR1_BR)  == SPI_BAUDRATEPRESCALER_16, "job after a failed DMA init gets the CubeMX prescaler");
+  check((SPI1->CR1 & SPI_CR1_DFF) == SPI_DATASIZE_8BIT,        "job after a failed DMA init gets the CubeMX frame size");
+  check(hspi1.Init.DataSize == SPI_DATASIZE_8BIT,              "handle is back on the CubeMX frame size");
+  check(hspi1.hdmatx->Init.PeriphDataAlignment == DMA_PDATAALIGN_BYTE, "tx DMA is set back to byte width");
+  check(hspi1.hdmarx->Init.PeriphDataAlignment == DMA_PDATAALIGN_BYTE, "rx DMA is set back to byte width");
+  check(hostHALCompleteTransfer(&hspi1, NULL) && (defaultDevice.completeCount == 2U), "job after a failed DMA init retires");
+}
+
+
+/* Completes the pending transfer from the bus's DMA interrupt, clocking in the inverse of the tx byte */
+static bool completeFromBusIRQ(void)
+{
+  HostSPIPending_t pending = hostHALPendingTransfer(&hspi1);
+
+  if (pending.kind == HOST_SPI_IDLE)
+  {
+    return (false);
+  }
+
+  uint8_t misoByte = static_cast<uint8_t>(~pending.txBuffer[0]);
+
+  hostIPSR = DMA2_Stream0_IRQn + 16;
+  hostHALCompleteTransfer(&hspi1, &misoByte);
+  hostIPSR = 0U;
+
+  return (true);
+}
+
+
+/* Submissions from thread mode and from completion callbacks, interleaved with completions, must keep the
+ * queue in order - every job retires once, in submission order, with its own data */
+static void testInterleavedSubmitComplete(void)
+{
+  StressDevice device;
+  uint32_t     state       = 0x2468ACE1U;
+  uint32_t     assertCount = hostHALAssertCount();
+
+  NVIC_SetPriority(DMA2_Stream0_IRQn, SPI_BUS_TOPOLOGY[SPI_BUS_1].IRQPriority);
+
+  for (uint32_t round = 0U; round < 4096U; round++)
+  {
+    state = (state * 1664525U) + 1013904223U;
+
+    for (uint32_t submission = 0U; submission < ((state >> 8U) & 3U); submission++)
+    {
+      (void)device.submit();
+    }
+
+    device.resubmitBudget = (state >> 12U) & 1U;
+
+    for (uint32_t completion = 0U; completion < ((state >> 16U) & 3U); completion++)
+    {
+      (void)completeFromBusIRQ();
+    }
+  }
+
+  device.resubmitBudget = 0U;
+
+  while (completeFromBusIRQ()) {}
+
+  check(device.submittedCount > static_cast<uint32_t>(SPI_JOB_QUEUE_SIZE), "stress test queues more jobs than the queue holds");
+  check(device.completedCount == device.submittedCount,                   "every stress job retires");
+  check(device.unexpectedCount == 0U,                                     "stress jobs retire in order with their own data");
+  check(hostBASEPRI == 0U,                                                "stress test leaves the bus critical section");
+  check(hostHALAssertCount() == assertCount,                              "submitters at the bus priority pass the priority check");
+  check(chipSelectReleased(),                                             "chip select is released once the stress queue drains");
+}
+
+
+/* A submitter above the bus interrupt's priority is not masked by the bus critical section */
+static void testSubmitAbovePriorityAsserts(void)
+{
+#ifdef USE_FULL_ASSERT
+  TestDevice device;
+  uint8_t    txBuffer[1] = {0U};
+  uint32_t   assertCount = hostHALAssertCount();
+
+  NVIC_SetPriority(TIM2_IRQn, SPI_BUS_TOPOLOGY[SPI_BUS_1].IRQPriority - 1U);
+
+  hostIPSR = TIM2_IRQn + 16;
+  (void)device.queue(txBuffer, NULL, 1U);
+  hostIPSR = 0U;
+
+  check(hostHALAssertCount() == (assertCount + 1U), "submitting above the bus priority fails the priority check");
+
+  NVIC_SetPriority(TIM2_IRQn, SPI_BUS_TOPOLOGY[SPI_BUS_1].IRQPriority + 1U);
+
+  hostIPSR = TIM2_IRQn + 16;
+  (void)device.queue(txBuffer, NULL, 1U);
+  hostIPSR = 0U;
+
+  check(hostHALAssertCount() == (assertCount + 1U), "submitting below the bus priority passes the priority check");
+
+  while (hostHALCompleteTransfer(&hspi1, NULL)) {}
+#endif
+}
+
+
+/* A stream is clocked by the trigger timer's compare DMA request, never by the SPI's own TXE request */
+static void testTimerPacedStream(void)
+{
+  const SPI::SPIBusConfig_t streamConfig = { .baudRatePrescaler = SPI_BAUDRATEPRESCALER_4,
+                                             .clockPolarity     = SPI_POLARITY_HIGH,
+                                             .clockPhase        = SPI_PHASE_1EDGE,
+                                             .dataSize          = SPI_DATASIZE_8BIT };
+
+  TestDevice         device(streamConfig);
+  TIM_TypeDef        timer          = {};
+  DMA_Stream_TypeDef timerDMAStream = {};
+  DMA_HandleTypeDef  timerDMA       = { .Instance = &timerDMAStream, .Init = {}, .Parent = NULL,
+                                        .XferCpltCallback = NULL, .XferHalfCpltCallback = NULL, .XferErrorCallback = NULL };
+  TIM_HandleTypeDef  triggerTimer   = { .Instance = &timer, .hdma = {NULL} };
+  uint8_t            txRing[12]     = {0U};
+  uint8_t            rxRing[12]     = {0U};
+
+  triggerTimer.hdma[TIM_DMA_ID_CC1] = &timerDMA;
+
+  check(device.getLatestStreamFrameIndex(SPI_BUS_1) == SPI_STREAM_NO_FRAME, "no frame index before a stream starts");
+
+  /* A bus without an rx DMA stream cannot stream - refused before anything is touched */
+  DMA_HandleTypeDef* rxDMA = hspi1.hdmarx;
+
+  hspi1.hdmarx = NULL;
+  check(device.stream(&triggerTimer, txRing, rxRing, 3U, 4U) == STATUS_ERROR, "stream without rx DMA is refused");
+  hspi1.hdmarx = rxDMA;
+
+  check(device.getLatestStreamFrameIndex(SPI_BUS_1) == SPI_STREAM_NO_FRAME, "refused stream is not left active");
+
+  check(device.stream(&triggerTimer, txRing, rxRing, 3U, 4U) == STATUS_OK, "stream starts");
+  check(hostBASEPRI == 0U, "stream start leaves the bus critical section");
+
+  /* The device's settings are on the wire before the first frame */
+  check((SPI1->CR1 & SPI_CR1_BR)   == SPI_BAUDRATEPRESCALER_4, "stream applies the device's prescaler");
+  check((SPI1->CR1 & SPI_CR1_CPOL) == SPI_POLARITY_HIGH,       "stream applies the device's clock polarity");
+  check((SPI1->CR1 & SPI_CR1_CPHA) == SPI_PHASE_1EDGE,         "stream applies the device's clock phase");
+
+  /* Tx items only move on the timer's compare request */
+  HostDMAStream_t txStream = hostHALDMAStream(&timerDMA);
+  HostDMAStream_t rxStream = hostHALDMAStream(hspi1.hdmarx);
+
+  check(hostHALPendingTransfer(&hspi1).kind == HOST_SPI_IDLE,          "stream does not start an SPI-paced transfer");
+  check((SPI1->CR2 & SPI_CR2_TXDMAEN) == 0U,                           "SPI tx DMA request stays off while streaming");
+  check((SPI1->CR2 & SPI_CR2_RXDMAEN) != 0U,                           "SPI rx DMA request is on while streaming");
+  check(txStream.running && (timerDMA.Init.Mode == DMA_CIRCULAR),      "timer DMA runs the tx ring circularly");
+  check(txStream.sourceAddress      == hostAddress(txRing),            "timer DMA reads the tx ring");
+  check(txStream.destinationAddress == hostAddress(&SPI1->DR),         "timer DMA writes the SPI data register");
+  check(txStream.length == sizeof(txRing),                             "timer DMA covers the whole tx ring");
+  check((timer.DIER & TIM_DMA_CC1) != 0U,                              "trigger channel compare DMA request is enabled");
+  check((timer.CR1 & 1U) != 0U,                                        "trigger timer is running");
+  check(rxStream.running && rxStream.interrupts,                       "rx DMA runs with ring interrupts");
+  check(hspi1.hdmarx->Init.Mode == DMA_CIRCULAR,                       "rx DMA runs the rx ring circularly");
+  check(rxStream.length == sizeof(rxRing),                             "rx DMA covers the whole rx ring");
+
+  uint8_t    txBuffer[1] = {0U};
+  TestDevice otherDevice;
+
+  check(device.queue(txBuffer, NULL, 1U) == STATUS_ERROR, "jobs are refused while streaming");
+
+  /* Two whole frames and part of a third are in - the newest complete frame is index 1 */
+  hspi1.hdmarx->Instance->NDTR = 5U;
+
+  check(device.getLatestStreamFrameIndex(SPI_BUS_1) == 1U,                       "stream owner gets the newest complete frame");
+  check(otherDevice.getLatestStreamFrameIndex(SPI_BUS_1) == SPI_STREAM_NO_FRAME, "other devices get no frame index");
+
+  /* Ring halves reach the device through the SPI callback routing */
+  check(hostHALDMAEvent(hspi1.hdmarx, true),  "rx ring half event is raised");
+  check(hostHALDMAEvent(hspi1.hdmarx, false), "rx ring full event is raised");
+  check(device.streamHalfCount == 1U,     "half ring reaches streamHalfComplete");
+  check(device.streamCompleteCount == 1U, "full ring reaches streamComplete");
+
+  check(device.stopStream(SPI_BUS_1) == STATUS_OK, "stream stops");
+  check(hostBASEPRI == 0U, "stream stop leaves the bus critical section");
+  check((timer.CR1 & 1U) == 0U,                            "trigger timer is stopped");
+  check((timer.DIER & TIM_DMA_CC1) == 0U,                  "trigger channel compare DMA request is disabled");
+  check(!hostHALDMAStream(&timerDMA).running,              "timer DMA is stopped");
+  check(!hostHALDMAStream(hspi1.hdmarx).running,           "rx DMA is stopped");
+  check((SPI1->CR2 & SPI_CR2_RXDMAEN) == 0U,               "SPI rx DMA request is off after the stream");
+  check(hspi1.hdmarx->Init.Mode == DMA_NORMAL,             "rx DMA is back in normal mode");
+
+  check(device.getLatestStreamFrameIndex(SPI_BUS_1) == SPI_STREAM_NO_FRAME, "no frame index once the stream stops");
+  check(device.stopStream(SPI_BUS_1) == STATUS_ERROR, "stopping an idle bus is refused");
+  check(hostBASEPRI == 0U, "refused stop leaves the bus critical section");
+
+  /* Jobs run again, with the bus back on the CubeMX settings for a device without its own */
+  TestDevice defaultDevice;
+
+  check(defaultDevice.queue(txBuffer, NULL, 1U) == STATUS_OK, "jobs are accepted after the stream");
+  check((SPI1->CR1 & SPI_CR1_BR) == SPI_BAUDRATEPRESCALER_16, "job after the stream restores the CubeMX prescaler");
+  check(hostHALCompleteTransfer(&hspi1, NULL) && (defaultDevice.completeCount == 1U), "job after the stream retires");
+}
+
+/**
+  * @brief  Reports how many MB/s of jobs the bus driver moves on the host stand-in, from encoder-sized frames
+  *         up to the largest single segment. Transfers complete as soon as they are raised, so this is the
+  *         driver's per-job cost (queue, chip select, DMA set-up, callback) against the data moved - the
+  *         ceiling the driver puts on a bus, not what the wire carries
+  */
+static void reportThroughput(void)
+{
+  const uint16_t JOB_LENGTHS[]   = { 3U, 64U, 1024U, 16384U, 65535U };
+  const uint32_t JOBS_PER_SIZE   = 50000U;
+  const uint32_t JOBS_IN_FLIGHT  = 4U;
+
+  TestDevice           device;
+  std::vector<uint8_t> txBuffer(65535U, 0xA5U);
+  std::vector<uint8_t> rxBuffers[2] = { std::vector<uint8_t>(65535U), std::vector<uint8_t>(65535U) };
+
+  for (uint16_t length : JOB_LENGTHS)
+  {
+    uint32_t jobCount  = JOBS_PER_SIZE;
+    uint32_t submitted = 0U;
+    uint32_t completed = device.completeCount;
+
+    auto start = std::chrono::steady_clock::now();
+
+    /* A few jobs queued at once, alternating rx buffers so each is pipelined behind the one before */
+    while (submitted < jobCount)
+    {
+      while ((submitted < jobCount) && ((submitted - (device.completeCount - completed)) < JOBS_IN_FLIGHT))
+      {
+        (void)device.queue(txBuffer.data(), rxBuffers[submitted & 1U].data(), length);
+        submitted++;
+      }
+
+      (void)hostHALCompleteTransfer(&hspi1, NULL);
+    }
+
+    while (hostHALCompleteTransfer(&hspi1, NULL)) {}
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    check((device.completeCount - completed) == jobCount, "every benchmark job retires");
+
+    std::fprintf(stderr, "%5u-byte jobs: %10.1f MB/s, %9.0f jobs/s\n", length,
+                 (static_cast<double>(jobCount) * length) / (seconds * 1.0e6), jobCount / seconds);
+  }
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(void)
+{
+  testReceiveOnlyJob();
+  testQueuedReceiveOnlyJobs();
+  testTransmitOnlyJob();
+  testQueuedTimestampPerJob();
+  testPipelinedCompletion();
+  testSharedRxBufferNotPipelined();
+  testChainedSegments();
+  testGroupByConfigReordering();
+  testCaptureOfWideFrames();
+  testFailedDMAInitKeepsDefaults();
+  testTimerPacedStream();
+  testAwaitOnFullQueue();
+  testInterleavedSubmitComplete();
+  testSubmitAbovePriorityAsserts();
+  reportThroughput();
+
+  if (failureCount > 0U)
+  {
+    std::fprintf(stderr, "%lu checks failed\n", static_cast<unsigned long>(failureCount));
+    return (EXIT_FAILURE);
+  }
+
+  std::fprintf(stderr, "all SPI bus checks passed\n");
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,127 @@
+/**
+  ******************************************************************************
+  * @file    telemetryDecoder.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side tool which decodes a captured encoder telemetry stream
+  *          to CSV and reports how well it compressed.
+  *
+  *          Usage: telemetryDecoder <telemetry.bin> [samples.csv]
+  *
+  *          Decoded samples are written as "timestamp,position,status,
+  *          deviceStatus" lines to the output file (stdout if omitted). The
+  *          summary compares the stream against raw 8-byte samples (u16
+  *          position, u8 status, u8 device status, u32 timestamp).
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Utilities/telemetryFormat.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+const uint8_t RAW_SAMPLE_SIZE = 8U;
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s <telemetry.bin> [samples.csv]\n", argv[0]);
+    return (EXIT_FAILURE);
+  }
+
+  FILE* input = std::fopen(argv[1], "rb");
+
+  if (input == NULL)
+  {
+    std::perror(argv[1]);
+    return (EXIT_FAILURE);
+  }
+
+  std::vector<uint8_t> stream;
+  uint8_t              chunk[4096];
+  size_t               chunkLength;
+
+  while ((chunkLength = std::fread(chunk, 1U, sizeof(chunk), input)) > 0U)
+  {
+    stream.insert(stream.end(), chunk, chunk + chunkLength);
+  }
+
+  std::fclose(input);
+
+  FILE* output = (argc > 2) ? std::fopen(argv[2], "w") : stdout;
+
+  if (output == NULL)
+  {
+    std::perror(argv[2]);
+    return (EXIT_FAILURE);
+  }
+
+  TelemetryDecoderState_t state       = TELEMETRY_DECODER_INITIAL_STATE;
+  uint32_t                offset      = 0U;
+  uint64_t                sampleCount = 0U;
+
+  while (offset < stream.size())
+  {
+    uint32_t length = decodeTelemetryRecord(&stream[offset], static_cast<uint32_t>(stream.size() - offset), &state);
+
+    if (length == 0U)
+    {
+      std::fprintf(stderr, "corrupt or truncated record at offset %lu\n", static_cast<unsigned long>(offset));
+      break;
+    }
+
+    offset += length;
+
+    if (state.synchronised)
+    {
+      std::fprintf(output, "%lu,%u,%u,%u\n", static_cast<unsigned long>(state.timestamp), state.position, state.status, state.deviceStatus);
+      sampleCount++;
+    }
+  }
+
+  if (output != stdout)
+  {
+    std::fclose(output);
+  }
+
+  if (sampleCount > 0U)
+  {
+    std::fprintf(stderr, "%llu samples in %lu bytes: %.2f bytes/sample, compression ratio %.2f:1\n",
+                 static_cast<unsigned long long>(sampleCount), static_cast<unsigned long>(offset),
+                 static_cast<double>(offset) / sampleCount,
+                 static_cast<double>(sampleCount * RAW_SAMPLE_SIZE) / offset);
+  }
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,363 @@
+/**
+  ******************************************************************************
+  * @file    telemetryHostTest.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   Host-side test which runs sample sequences through the telemetry
+  *          encoder and back through the stream decoder, and checks every
+  *          sample comes back bit-exact. Sequences cover position wraps both
+  *          ways and half-turn steps, error and device status changes,
+  *          timestamp gaps and counter wraps, keyframe intervals and buffer
+  *          swaps, and a link too slow to keep up. Also reports the host's
+  *          encode time per sample.
+  *
+  *          Usage: telemetryHostTest
+  *
+  *          Build with Utilities/telemetryEncoder.cpp, Utilities/utilities.cpp,
+  *          Tools/hostHAL/hostHAL.cpp and -ITools/hostHAL.
+  *          Exits with EXIT_FAILURE if any check fails.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Utilities/telemetryEncoder.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+const uint32_t SEQUENCE_LENGTH       = 20000U;
+const uint32_t TIMING_SAMPLE_COUNT   = 1000000U;
+
+/* 10 kHz sampling at the F4's 168 MHz core clock */
+const uint32_t SAMPLE_PERIOD         = 16800U;
+
+/* Only the first few mismatches are printed - one broken record fails every sample after it */
+const uint32_t MAX_REPORTED_FAILURES = 8U;
+
+/*************************************************************************************/
+/* PRIVATE TYPEDEFS                                                                  */
+/*************************************************************************************/
+
+typedef struct
+{
+  uint16_t position;
+  uint8_t  status;
+  uint8_t  deviceStatus;
+  uint32_t timestamp;
+
+} Sample_t;
+
+/*************************************************************************************/
+/* CAPTURING ENCODER                                                                 */
+/*************************************************************************************/
+
+/* Collects every buffer handed over, as the link would send it. A held link keeps its buffer in flight */
+class CapturingTelemetry:
+public TelemetryEncoder
+{
+
+  public:
+
+  std::vector<uint8_t> stream;
+  bool                 linkHeld = false;
+
+  CapturingTelemetry(uint8_t positionResolution) : TelemetryEncoder(positionResolution) {}
+
+  void releaseHeldBuffer(void)
+  {
+    linkHeld = false;
+    releaseBuffer();
+  }
+
+  private:
+
+  virtual void bufferReady(const uint8_t* buffer, uint16_t length) final
+  {
+    stream.insert(stream.end(), buffer, buffer + length);
+
+    if (!linkHeld)
+    {
+      releaseBuffer();
+    }
+  }
+
+};
+
+/*************************************************************************************/
+/* PRIVATE VARIABLES                                                                 */
+/*************************************************************************************/
+
+static uint32_t failureCount = 0U;
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+static void check(bool condition, const char* description)
+{
+  if (!condition)
+  {
+    if (failureCount < MAX_REPORTED_FAILURES)
+    {
+      std::fprintf(stderr, "FAIL: %s\n", description);
+    }
+
+    failureCount++;
+  }
+}
+
+
+static uint32_t nextRandom(uint32_t* state)
+{
+  *state = (*state * 1664525U) + 1013904223U;
+
+  return (*state);
+}
+
+
+/**
+  * @brief  Mostly smooth motion at a steady rate, broken up by every awkward case the format has
+  */
+static std::vector<Sample_t> buildSequence(uint8_t positionResolution, uint32_t seed)
+{
+  std::vector<Sample_t> samples;
+
+  uint16_t positionMask = static_cast<uint16_t>((1UL << positionResolution) - 1U);
+  uint16_t halfTurn     = static_cast<uint16_t>(1UL << (positionResolution - 1U));
+  uint32_t state        = seed;
+
+  /* Starts just below the counter wrap, so the timestamp wraps early in the sequence */
+  Sample_t sample       = { .position = static_cast<uint16_t>(positionMask - 20U), .status = 0U, .deviceStatus = 0U,
+                            .timestamp = 0xFFFFFFFFU - (50U * SAMPLE_PERIOD) };
+
+  for (uint32_t index = 0U; index < SEQUENCE_LENGTH; index++)
+  {
+    uint32_t random = nextRandom(&state);
+
+    switch ((random >> 24U) & 0x3FU)
+    {
+      /* Half a turn either way - the largest step the wrapped delta carries */
+      case 0U:  sample.position = static_cast<uint16_t>(sample.position + halfTurn);          break;
+      case 1U:  sample.position = static_cast<uint16_t>(sample.position - halfTurn + 1U);     break;
+
+      /* Transfer, CRC and status errors, then recovery */
+      case 2U:  sample.status = static_cast<uint8_t>(1U + ((random >> 8U) % 3U));             break;
+      case 3U:  sample.status = 0U;                                                             break;
+
+      /* The encoder's own error and warning bits */
+      case 4U:  sample.deviceStatus = static_cast<uint8_t>(random >> 16U);                    break;
+
+      /* A gap - samples lost or the trigger paused, up to most of the counter's range */
+      case 5U:  sample.timestamp += random >> ((random >> 8U) & 7U);                           break;
+
+      /* A sample taken early, so the interval shrinks and then recovers */
+      case 6U:  sample.timestamp -= SAMPLE_PERIOD / 2U;                                         break;
+
+      default:                                                                                  break;
+    }
+
+    /* Smooth motion with jitter, crossing zero both ways */
+    int32_t velocity = static_cast<int32_t>((index / 1000U) % 5U) * 40 - 80;
+
+    sample.position   = static_cast<uint16_t>(sample.position + velocity + static_cast<int32_t>(random & 7U) - 3) & positionMask;
+    sample.timestamp += SAMPLE_PERIOD + (random & 0xFU);
+
+    samples.push_back(sample);
+  }
+
+  return (samples);
+}
+
+
+static std::vector<Sample_t> decodeStream(const std::vector<uint8_t>& stream, bool* streamIntact)
+{
+  std::vector<Sample_t>   samples;
+  TelemetryDecoderState_t state  = TELEMETRY_DECODER_INITIAL_STATE;
+  uint32_t                offset = 0U;
+
+  *streamIntact = true;
+
+  while (offset < stream.size())
+  {
+    uint32_t length = decodeTelemetryRecord(&stream[offset], static_cast<uint32_t>(stream.size() - offset), &state);
+
+    if (length == 0U)
+    {
+      *streamIntact = false;
+      break;
+    }
+
+    offset += length;
+
+    if (state.synchronised)
+    {
+      samples.push_back({ .position = state.position, .status = state.status, .deviceStatus = state.deviceStatus,
+                          .timestamp = state.timestamp });
+    }
+  }
+
+  return (samples);
+}
+
+
+static bool samplesMatch(const Sample_t& decoded, const Sample_t& encoded)
+{
+  return ((decoded.position     == encoded.position)     &&
+          (decoded.status       == encoded.status)       &&
+          (decoded.deviceStatus == encoded.deviceStatus) &&
+          (decoded.timestamp    == encoded.timestamp)      );
+}
+
+
+/* Every sample must come back exactly as it went in */
+static void testRoundTrip(uint8_t positionResolution, uint32_t seed)
+{
+  std::vector<Sample_t> samples = buildSequence(positionResolution, seed);
+  CapturingTelemetry    telemetry(positionResolution);
+  bool                  allAccepted = true;
+
+  for (const Sample_t& sample : samples)
+  {
+    allAccepted = allAccepted && (telemetry.addSample(sample.position, sample.status, sample.deviceStatus, sample.timestamp) == STATUS_OK);
+  }
+
+  check(telemetry.flush() == STATUS_OK, "partly filled buffer is flushed");
+  check(allAccepted && (telemetry.getDroppedSampleCount() == 0U), "no samples are dropped on a free link");
+
+  bool                  streamIntact;
+  std::vector<Sample_t> decoded = decodeStream(telemetry.stream, &streamIntact);
+
+  check(streamIntact, "stream decodes to its end");
+  check(decoded.size() == samples.size(), "decoder returns every sample");
+
+  for (uint32_t index = 0U; (index < decoded.size()) && (index < samples.size()); index++)
+  {
+    check(samplesMatch(decoded[index], samples[index]), "decoded sample matches the encoded one");
+  }
+
+  std::fprintf(stderr, "%u-bit: %lu samples in %lu bytes, %.2f bytes/sample\n", positionResolution,
+               static_cast<unsigned long>(samples.size()), static_cast<unsigned long>(telemetry.stream.size()),
+               static_cast<double>(telemetry.stream.size()) / samples.size());
+}
+
+
+/* Samples arriving while both buffers are taken are dropped and counted - the rest still decode exactly */
+static void testHeldLinkDropsSamples(void)
+{
+  std::vector<Sample_t> samples = buildSequence(14U, 0xC0FFEEU);
+  std::vector<Sample_t> kept;
+  CapturingTelemetry    telemetry(14U);
+  uint32_t              droppedCount = 0U;
+
+  telemetry.linkHeld = true;
+
+  for (uint32_t index = 0U; index < samples.size(); index++)
+  {
+    const Sample_t& sample = samples[index];
+
+    if (telemetry.addSample(sample.position, sample.status, sample.deviceStatus, sample.timestamp) == STATUS_OK)
+    {
+      kept.push_back(sample);
+    }
+    else
+    {
+      droppedCount++;
+    }
+
+    /* The link catches up now and then */
+    if ((index % 500U) == 499U)
+    {
+      telemetry.releaseHeldBuffer();
+      telemetry.linkHeld = true;
+    }
+  }
+
+  telemetry.releaseHeldBuffer();
+
+  check(telemetry.flush() == STATUS_OK, "held link's last buffer is flushed");
+  check(droppedCount > 0U, "a held link drops samples");
+  check(telemetry.getDroppedSampleCount() == droppedCount, "every dropped sample is counted");
+
+  bool                  streamIntact;
+  std::vector<Sample_t> decoded = decodeStream(telemetry.stream, &streamIntact);
+
+  check(streamIntact, "stream with drops decodes to its end");
+  check(decoded.size() == kept.size(), "decoder returns every sample that was kept");
+
+  for (uint32_t index = 0U; (index < decoded.size()) && (index < kept.size()); index++)
+  {
+    check(samplesMatch(decoded[index], kept[index]), "decoded sample matches the kept one");
+  }
+}
+
+
+/* Host time only - on the target addSample runs in the bus completion ISR, so time it there with the DWT cycle counter */
+static void reportEncodeTime(void)
+{
+  std::vector<Sample_t> samples = buildSequence(14U, 0x5EED5EEDU);
+  CapturingTelemetry    telemetry(14U);
+
+  telemetry.stream.reserve(TIMING_SAMPLE_COUNT * 4U);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint32_t index = 0U; index < TIMING_SAMPLE_COUNT; index++)
+  {
+    const Sample_t& sample = samples[index % samples.size()];
+
+    (void)telemetry.addSample(sample.position, sample.status, sample.deviceStatus, sample.timestamp + index);
+  }
+
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::fprintf(stderr, "encode: %.1f ns/sample on the host\n", elapsed / TIMING_SAMPLE_COUNT);
+}
+
+/*************************************************************************************/
+/* MAIN                                                                              */
+/*************************************************************************************/
+
+int main(void)
+{
+  testRoundTrip(14U, 0x12345678U);
+  testRoundTrip(16U, 0x9ABCDEF0U);
+  testRoundTrip(12U, 0x0BADF00DU);
+  testHeldLinkDropsSamples();
+  reportEncodeTime();
+
+  if (failureCount > 0U)
+  {
+    std::fprintf(stderr, "%lu checks failed\n", static_cast<unsigned long>(failureCount));
+    return (EXIT_FAILURE);
+  }
+
+  std::fprintf(stderr, "all telemetry samples round-trip\n");
+
+  return (EXIT_SUCCESS);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -31,6 +31,7 @@
 
 #include <stdint.h>
 
+/* Kept free of HAL includes so the host-side batch decoder shares this table */
 const uint16_t DECIMAL_WIDTH_8_BIT = 256U;
 
 /*************************************************************************************/
@@ -44,12 +45,47 @@ class CRC8
 
   /*-- Public Prototypes ------------------------------------------------------------*/
 
-  CRC8(uint8_t generatorPolynomial);
-
-  uint8_t calculateCRC8(uint8_t* byteBuffer, uint8_t length);
+  /* constexpr so a table built from a constant polynomial is computed by the compiler and placed in flash */
+  constexpr CRC8(uint8_t generatorPolynomial)
+  {
+    /* iterate over all byte values 0 - 255 */
+    for (uint16_t divident = 0U; divident < DECIMAL_WIDTH_8_BIT; divident++)
+    {
+      uint8_t currentByte = static_cast<uint8_t>(divident);
+
+      /* calculate the CRC-8 value for current byte */
+      for (uint8_t bit = 0U; bit < BITS_PER_BYTE; bit++)
+      {
+        if ((currentByte & BYTE_MSB_HIGH) != 0U)
+        {
+          currentByte = static_cast<uint8_t>((currentByte << 1U) ^ generatorPolynomial);
+        }
+        else
+        {
+          currentByte = static_cast<uint8_t>(currentByte << 1U);
+        }
+      }
+
+      /* store CRC value in lookup table */
+      _CRCTable[divident] = currentByte;
+    }
+  }
+
+  uint8_t calculateCRC8(const uint8_t* byteBuffer, uint8_t length, uint8_t initialValue = 0U) const;
+
+  /* CRC of a single byte from a zero register - the building block for decoders that split the CRC up */
+  constexpr uint8_t getTableEntry(uint8_t divident) const
+  {
+    return (_CRCTable[divident]);
+  }
 
   private:
 
+  /*-- Private Constants ------------------------------------------------------------*/
+
+  static const uint8_t BYTE_MSB_HIGH = 0x80U;
+  static const uint8_t BITS_PER_BYTE = 8U;
+
   /*-- Private Variables ------------------------------------------------------------*/
 
   uint8_t _CRCTable[DECIMAL_WIDTH_8_BIT] = {0U};
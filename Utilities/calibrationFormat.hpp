@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file    calibrationFormat.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines and inline functions describing the encoder
+  *          linearity calibration blob. Kept free of HAL includes so the
+  *          host-side fitting tool can share it with the target driver.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __calibrationFormat_H
+#define __calibrationFormat_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/*
+ * Blob layout (little-endian):
+ *
+ *   [0]     magic 'R'
+ *   [1]     magic 'L'
+ *   [2]     format version
+ *   [3]     log2 of the table entry count
+ *   [4]     position resolution in bits the table was fitted for
+ *   [5]     fractional bits of each correction entry
+ *   [6..7]  Fletcher-16 checksum over the entries
+ *   [8..]   entries - int16 corrections added to the position at evenly spaced
+ *           points around one turn, interpolated and wrapped between them
+ */
+
+const uint8_t CALIBRATION_MAGIC_0             = 'R';
+const uint8_t CALIBRATION_MAGIC_1             = 'L';
+const uint8_t CALIBRATION_FORMAT_VERSION      = 1U;
+
+const uint8_t CALIBRATION_HEADER_SIZE         = 8U;
+const uint8_t CALIBRATION_ENTRY_SIZE          = 2U;
+
+const uint8_t CALIBRATION_MIN_ENTRIES_LOG2    = 4U;
+const uint8_t CALIBRATION_MAX_ENTRIES_LOG2    = 12U;
+const uint8_t CALIBRATION_FRACTION_BITS       = 4U;
+
+typedef enum: uint8_t
+{
+  CALIBRATION_OFFSET_MAGIC_0         = 0U,
+  CALIBRATION_OFFSET_MAGIC_1         = 1U,
+  CALIBRATION_OFFSET_VERSION         = 2U,
+  CALIBRATION_OFFSET_ENTRIES_LOG2    = 3U,
+  CALIBRATION_OFFSET_RESOLUTION      = 4U,
+  CALIBRATION_OFFSET_FRACTION_BITS   = 5U,
+  CALIBRATION_OFFSET_CHECKSUM        = 6U,
+} CalibrationHeaderOffset_t;
+
+/*************************************************************************************/
+/* INLINE FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+static inline uint16_t calibrationChecksum(const uint8_t* byteBuffer, uint32_t length)
+{
+  uint16_t sum1 = 0U;
+  uint16_t sum2 = 0U;
+
+  for (uint32_t index = 0U; index < length; index++)
+  {
+    sum1 = (sum1 + byteBuffer[index]) % 255U;
+    sum2 = (sum2 + sum1) % 255U;
+  }
+
+  return (static_cast<uint16_t>((sum2 << 8U) | sum1));
+}
+
+
+#endif /* __calibrationFormat_H */
+
+/**
+  * @}End of File
+  */
+
+
@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file    coroutineTask.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the coroutine frame pool, the cooperative executor
+  *          and the ISR-to-task completion handoff.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "coroutineTask.hpp"
+
+/*************************************************************************************/
+/* STATIC MEMBERS                                                                    */
+/*************************************************************************************/
+
+alignas(8) uint8_t CoroutineFramePool::_frames[COROUTINE_FRAME_COUNT][COROUTINE_FRAME_SIZE];
+
+uint32_t CoroutineFramePool::_usedFrameMask = 0U;
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/**
+  * @brief  Takes a free frame from the pool
+  *
+  * @param  size: Frame size the compiler needs for the coroutine
+  *
+  * @retval void*: The frame, or NULL if the coroutine is too large or the pool is exhausted
+  */
+void* CoroutineFramePool::allocate(size_t size)
+{
+  if (size > COROUTINE_FRAME_SIZE)
+  {
+    return (NULL);
+  }
+
+  void*    frame   = NULL;
+  uint32_t basepri = ENTER_PRIORITY_CRITICAL_SECTION(COROUTINE_IRQ_PRIORITY);
+
+  for (uint8_t index = 0U; index < COROUTINE_FRAME_COUNT; index++)
+  {
+    if ((_usedFrameMask & (1UL << index)) == 0U)
+    {
+      _usedFrameMask |= (1UL << index);
+      frame           = _frames[index];
+      break;
+    }
+  }
+
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+
+  return (frame);
+}
+
+
+void CoroutineFramePool::release(void* frame)
+{
+  uint32_t index   = static_cast<uint32_t>((static_cast<uint8_t*>(frame) - &_frames[0][0]) / COROUTINE_FRAME_SIZE);
+  uint32_t basepri = ENTER_PRIORITY_CRITICAL_SECTION(COROUTINE_IRQ_PRIORITY);
+
+  _usedFrameMask &= ~(1UL << index);
+
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+}
+
+
+uint8_t CoroutineFramePool::getFreeFrameCount(void)
+{
+  return (static_cast<uint8_t>(COROUTINE_FRAME_COUNT - __builtin_popcount(_usedFrameMask)));
+}
+
+
+void Task::YieldAwaiter::await_suspend(handle_t handle) noexcept
+{
+  handle.promise().executor->schedule(handle);
+}
+
+
+/**
+  * @brief  Starts a top-level task on this executor. The executor owns it from here and
+  *         frees its frame when it finishes.
+  *
+  * @param  task: Task to run, moved in
+  *
+  * @retval status_t: STATUS_ERROR if the task has no frame (the pool was exhausted)
+  */
+status_t CooperativeExecutor::spawn(Task task)
+{
+  if (!task.isValid())
+  {
+    return (STATUS_ERROR);
+  }
+
+  Task::handle_t handle = task._handle;
+
+  task._handle                = nullptr;
+  handle.promise().executor   = this;
+  handle.promise().detached   = true;
+
+  return (schedule(handle));
+}
+
+
+/**
+  * @brief  Queues a suspended task to be resumed by runReady. Safe to call from an ISR at or
+  *         below COROUTINE_IRQ_PRIORITY.
+  *
+  * @param  handle: Task to resume
+  *
+  * @retval status_t: STATUS_ERROR if the ready queue is full
+  */
+status_t CooperativeExecutor::schedule(std::coroutine_handle<> handle)
+{
+  uint32_t basepri = ENTER_PRIORITY_CRITICAL_SECTION(COROUTINE_IRQ_PRIORITY);
+
+  status_t status  = _readyQueue.push(handle);
+
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+
+  return (status);
+}
+
+
+/**
+  * @brief   Resumes every task which was ready on entry. Call from the main loop.
+  *
+  * @warning Tasks made ready while this runs wait for the next call, so a task which
+  *          yields in a loop cannot starve the caller.
+  *
+  * @param   None
+  *
+  * @retval  uint8_t: Number of tasks resumed
+  */
+uint8_t CooperativeExecutor::runReady(void)
+{
+  uint32_t basepri    = ENTER_PRIORITY_CRITICAL_SECTION(COROUTINE_IRQ_PRIORITY);
+  int8_t   readyCount = _readyQueue.getSize();
+  EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+
+  for (int8_t task = 0; task < readyCount; task++)
+  {
+    basepri = ENTER_PRIORITY_CRITICAL_SECTION(COROUTINE_IRQ_PRIORITY);
+
+    std::coroutine_handle<> handle = _readyQueue.front().data;
+    _readyQueue.pop();
+
+    EXIT_PRIORITY_CRITICAL_SECTION(basepri);
+
+    handle.resume();
+  }
+
+  return (static_cast<uint8_t>(readyCount));
+}
+
+
+/**
+  * @brief  Parks a task until complete() is called
+  *
+  * @param  handle: Suspended task to resume on completion
+  *
+  * @retval status_t: STATUS_ERROR if a task is already waiting
+  */
+status_t AwaitingCoroutine::attach(Task::handle_t handle)
+{
+  if (_handleAddress != NULL)
+  {
+    return (STATUS_ERROR);
+  }
+
+  _executor      = handle.promise().executor;
+  _status        = STATUS_ERROR;
+
+  /* Executor and status must land before the ISR can see the handle */
+  __DMB();
+
+  _handleAddress = handle.address();
+
+  return (STATUS_OK);
+}
+
+
+/**
+  * @brief  Releases the parked task without scheduling it, for operations which failed to start
+  */
+void AwaitingCoroutine::detach(void)
+{
+  _handleAddress = NULL;
+}
+
+
+/**
+  * @brief  Records the operation's result and hands the parked task to its executor.
+  *         Called from the completing ISR.
+  *
+  * @param  status: Result returned from the task's co_await
+  *
+  * @retval None
+  */
+void AwaitingCoroutine::complete(status_t status)
+{
+  void* handleAddress = _handleAddress;
+
+  if (handleAddress == NULL)
+  {
+    return;
+  }
+
+  _status        = status;
+
+  /* The status must land before the slot reads free, or a re-attach could reset it under the resumed task */
+  __DMB();
+
+  _handleAddress = NULL;
+
+  _executor->schedule(std::coroutine_handle<>::from_address(handleAddress));
+}
+
+
+status_t AwaitingCoroutine::getStatus(void)
+{
+  return (_status);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,339 @@
+/**
+  ******************************************************************************
+  * @file    coroutineTask.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the C++20 coroutine task type, its static frame
+  *          pool and the cooperative executor which resumes tasks from the
+  *          main loop once the interrupt driven operations they await finish.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __coroutineTask_H
+#define __coroutineTask_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+#include "utilities.hpp"
+#include "queue.hpp"
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/* Every coroutine frame comes from this pool - a coroutine whose frame is larger fails to start */
+const uint16_t COROUTINE_FRAME_SIZE       = 256U;
+const uint8_t  COROUTINE_FRAME_COUNT      = 16U;
+
+/* Each live coroutine is queued at most once, so one slot per frame can never overflow */
+const int8_t   COROUTINE_READY_QUEUE_SIZE = COROUTINE_FRAME_COUNT;
+
+/* Highest (numerically lowest) NVIC priority of an interrupt which completes awaited operations. The
+ * pool and executors only mask up to it, so PWM and current loop interrupts keep running - every SPI
+ * bus in SPI_BUS_TOPOLOGY is checked to be at or below it in STM32-SPIAsync.cpp */
+const uint32_t COROUTINE_IRQ_PRIORITY     = 5U;
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class CooperativeExecutor;
+
+
+class CoroutineFramePool
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  static void* allocate(size_t size);
+
+  static void release(void* frame);
+
+  static uint8_t getFreeFrameCount(void);
+
+  private:
+
+  /*-- Private Constants ------------------------------------------------------------*/
+
+  static_assert(COROUTINE_FRAME_COUNT <= 32U, "Frame usage is tracked in a 32-bit mask");
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  alignas(8) static uint8_t _frames[COROUTINE_FRAME_COUNT][COROUTINE_FRAME_SIZE];
+
+  static uint32_t           _usedFrameMask;
+
+};
+
+
+/*
+ * A coroutine returning Task runs on a CooperativeExecutor and co_returns a status_t.
+ * Tasks start suspended: spawn() a top-level task on an executor, or co_await it from
+ * another task to run it in sequence. Frames come from CoroutineFramePool, never the heap.
+ */
+class Task
+{
+
+  public:
+
+  /*-- Public Variables -------------------------------------------------------------*/
+
+  class promise_type
+  {
+
+    public:
+
+    CooperativeExecutor*    executor     = NULL;
+    std::coroutine_handle<> continuation = nullptr;
+    bool                    detached     = false;
+    status_t                result       = STATUS_ERROR;
+
+    static void* operator new(size_t size) noexcept
+    {
+      return (CoroutineFramePool::allocate(size));
+    }
+
+    static void operator delete(void* frame) noexcept
+    {
+      CoroutineFramePool::release(frame);
+    }
+
+    static Task get_return_object_on_allocation_failure(void) noexcept
+    {
+      return (Task());
+    }
+
+    Task get_return_object(void) noexcept
+    {
+      return (Task(std::coroutine_handle<promise_type>::from_promise(*this)));
+    }
+
+    std::suspend_always initial_suspend(void) noexcept
+    {
+      return {};
+    }
+
+    /* Hands control straight back to an awaiting task, or frees a finished detached task */
+    struct FinalAwaiter
+    {
+      bool await_ready(void) noexcept
+      {
+        return (false);
+      }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+      {
+        promise_type& promise = handle.promise();
+
+        if (promise.continuation)
+        {
+          return (promise.continuation);
+        }
+
+        if (promise.detached)
+        {
+          handle.destroy();
+        }
+
+        return (std::noop_coroutine());
+      }
+
+      void await_resume(void) noexcept {}
+    };
+
+    FinalAwaiter final_suspend(void) noexcept
+    {
+      return {};
+    }
+
+    void return_value(status_t status) noexcept
+    {
+      result = status;
+    }
+
+    /* Built without exceptions - nothing can reach here */
+    void unhandled_exception(void) noexcept {}
+
+  };
+
+
+  typedef std::coroutine_handle<promise_type> handle_t;
+
+
+  /* Awaiting a task runs it to completion on the awaiting task's executor */
+  struct TaskAwaiter
+  {
+    handle_t child;
+
+    bool await_ready(void) noexcept
+    {
+      return (!child);
+    }
+
+    std::coroutine_handle<> await_suspend(handle_t parent) noexcept
+    {
+      child.promise().executor     = parent.promise().executor;
+      child.promise().continuation = parent;
+
+      return (child);
+    }
+
+    status_t await_resume(void) noexcept
+    {
+      return (child ? child.promise().result : STATUS_ERROR);
+    }
+  };
+
+
+  /* Requeues the awaiting task behind everything already ready */
+  struct YieldAwaiter
+  {
+    bool await_ready(void) noexcept
+    {
+      return (false);
+    }
+
+    void await_suspend(handle_t handle) noexcept;
+
+    void await_resume(void) noexcept {}
+  };
+
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  Task(void) : _handle(nullptr) {}
+
+  Task(Task&& other) noexcept : _handle(other._handle)
+  {
+    other._handle = nullptr;
+  }
+
+  Task(const Task&) = delete;
+
+  Task& operator=(const Task&) = delete;
+
+  ~Task()
+  {
+    if (_handle)
+    {
+      _handle.destroy();
+    }
+  }
+
+  /* False if the frame pool had no room for the coroutine */
+  bool isValid(void)
+  {
+    return (static_cast<bool>(_handle));
+  }
+
+  TaskAwaiter operator co_await() && noexcept
+  {
+    return (TaskAwaiter{_handle});
+  }
+
+  static YieldAwaiter yield(void)
+  {
+    return {};
+  }
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  handle_t _handle;
+
+  /*-- Private Prototypes -----------------------------------------------------------*/
+
+  explicit Task(handle_t handle) : _handle(handle) {}
+
+  /*-- Friend Class Declarations ----------------------------------------------------*/
+
+  friend class CooperativeExecutor;
+
+};
+
+
+class CooperativeExecutor
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  CooperativeExecutor(void) {}
+
+  status_t spawn(Task task);
+
+  status_t schedule(std::coroutine_handle<> handle);
+
+  uint8_t runReady(void);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  QUEUE<std::coroutine_handle<>, COROUTINE_READY_QUEUE_SIZE> _readyQueue;
+
+};
+
+
+/*
+ * Parks one task until an interrupt completes the operation it is waiting on. Drivers
+ * keep one per outstanding operation and call complete() from their ISR callback.
+ */
+class AwaitingCoroutine
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  constexpr AwaitingCoroutine(void) {}
+
+  status_t attach(Task::handle_t handle);
+
+  void detach(void);
+
+  void complete(status_t status);
+
+  status_t getStatus(void);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  /* Shared with the completing ISR - the handle is held as its address so it can be volatile,
+   * and is published last so the ISR never sees it without its executor */
+  void* volatile                _handleAddress = NULL;
+  CooperativeExecutor* volatile _executor      = NULL;
+  volatile status_t             _status        = STATUS_ERROR;
+
+};
+
+
+#endif /* __coroutineTask_H */
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    deviceHealth.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the rolling-window health tracker which quarantines
+  *          a persistently failing device and restores it once its probes pass.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "deviceHealth.hpp"
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/**
+  * @brief   Replaces the policy and restores the device to healthy with an empty window
+  *
+  * @warning Call while no transfers are in flight - the tracker is not locked against its ISRs
+  *
+  * @param   config: New policy
+  *
+  * @retval  status_t: STATUS_ERROR if the policy is out of range, leaving the old one in place
+  */
+status_t DeviceHealthTracker::configure(DeviceHealthConfig_t config)
+{
+  if ((config.windowLength        == 0U)                  ||
+      (config.windowLength        >  32U)                 ||
+      (config.quarantineThreshold == 0U)                  ||
+      (config.quarantineThreshold >  config.windowLength) ||
+      (config.probeInterval       == 0U)                  ||
+      (config.recoveryCount       == 0U)                    )
+  {
+    return (STATUS_ERROR);
+  }
+
+  _config         = config;
+  _windowMask     = windowMask(config.windowLength);
+  _outcomeWindow  = 0U;
+  _state          = DEVICE_HEALTH_HEALTHY;
+  _goodProbeRun   = 0U;
+  _probeCountdown = 0U;
+
+  return (STATUS_OK);
+}
+
+
+/**
+  * @brief  Decides whether a transfer may start. Every transfer is admitted while healthy,
+  *         and one in probeInterval while quarantined.
+  *
+  * @param  None
+  *
+  * @retval bool: False if the transfer should be skipped
+  */
+bool DeviceHealthTracker::admit(void)
+{
+  if (_state == DEVICE_HEALTH_HEALTHY)
+  {
+    return (true);
+  }
+
+  if (_probeCountdown > 0U)
+  {
+    _probeCountdown--;
+    _skippedTransferCount++;
+    return (false);
+  }
+
+  _probeCountdown = _config.probeInterval - 1U;
+
+  return (true);
+}
+
+
+/**
+  * @brief  Adds a completed transfer's outcome to the window and moves the device between
+  *         healthy and quarantined
+  *
+  * @param  transferSucceeded: False for a transfer error, CRC failure or device status error
+  *
+  * @retval bool: True if the state changed
+  */
+bool DeviceHealthTracker::record(bool transferSucceeded)
+{
+  _outcomeWindow = (_outcomeWindow << 1U) | (transferSucceeded ? 0U : 1U);
+
+  if (_state == DEVICE_HEALTH_HEALTHY)
+  {
+    if (static_cast<uint8_t>(__builtin_popcount(_outcomeWindow & _windowMask)) < _config.quarantineThreshold)
+    {
+      return (false);
+    }
+
+    _goodProbeRun = 0U;
+    _quarantineCount++;
+    _state        = DEVICE_HEALTH_QUARANTINED;
+
+    return (true);
+  }
+
+  _goodProbeRun = transferSucceeded ? (_goodProbeRun + 1U) : 0U;
+
+  if (_goodProbeRun < _config.recoveryCount)
+  {
+    return (false);
+  }
+
+  /* Start the restored device with a clean window so the failures which quarantined it are not counted twice */
+  _outcomeWindow = 0U;
+  _state         = DEVICE_HEALTH_HEALTHY;
+
+  return (true);
+}
+
+
+DeviceHealthState_t DeviceHealthTracker::getState(void)
+{
+  return (_state);
+}
+
+
+DeviceHealthReport_t DeviceHealthTracker::getReport(void)
+{
+  DeviceHealthReport_t report = { .state                = _state,
+                                  .windowFailures       = static_cast<uint8_t>(__builtin_popcount(_outcomeWindow & _windowMask)),
+                                  .quarantineCount      = _quarantineCount,
+                                  .skippedTransferCount = _skippedTransferCount };
+
+  return (report);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    deviceHealth.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and the class declaration
+  *          for per-device health tracking over a rolling window of transfer
+  *          outcomes, with quarantine to a low-rate probe schedule.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __deviceHealth_H
+#define __deviceHealth_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include "utilities.hpp"
+
+/*************************************************************************************/
+/* TYPEDEFS                                                                          */
+/*************************************************************************************/
+
+typedef enum: uint8_t
+{
+  DEVICE_HEALTH_HEALTHY     = 0,
+  DEVICE_HEALTH_QUARANTINED = 1,
+} DeviceHealthState_t;
+
+
+/*
+ * A healthy device is quarantined once quarantineThreshold of its last windowLength
+ * transfers have failed. While quarantined only one transfer in probeInterval is let
+ * onto the bus, and recoveryCount consecutive good probes restore it.
+ */
+typedef struct
+{
+  uint8_t  windowLength;
+  uint8_t  quarantineThreshold;
+  uint16_t probeInterval;
+  uint8_t  recoveryCount;
+
+} DeviceHealthConfig_t;
+
+
+typedef struct
+{
+  DeviceHealthState_t state;
+  uint8_t             windowFailures;
+  uint32_t            quarantineCount;
+  uint32_t            skippedTransferCount;
+
+} DeviceHealthReport_t;
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/* Quarantine at a quarter of the last 32 transfers failing, then probe at 1/100 of the trigger rate */
+constexpr DeviceHealthConfig_t DEVICE_HEALTH_DEFAULT_CONFIG = { .windowLength        = 32U,
+                                                                .quarantineThreshold = 8U,
+                                                                .probeInterval       = 100U,
+                                                                .recoveryCount       = 3U };
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/*
+ * admit() is called where transfers are started and record() where they complete, which
+ * may be different interrupts - each only writes state the other reads, never shares.
+ */
+class DeviceHealthTracker
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  constexpr DeviceHealthTracker(DeviceHealthConfig_t config) : _config(config), _windowMask(windowMask(config.windowLength)) {}
+
+  status_t configure(DeviceHealthConfig_t config);
+
+  bool admit(void);
+
+  bool record(bool transferSucceeded);
+
+  DeviceHealthState_t getState(void);
+
+  DeviceHealthReport_t getReport(void);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  DeviceHealthConfig_t         _config;
+  uint32_t                     _windowMask;
+
+  /* Bit n set if the transfer n completions ago failed */
+  uint32_t                     _outcomeWindow        = 0U;
+
+  volatile DeviceHealthState_t _state                = DEVICE_HEALTH_HEALTHY;
+  uint8_t                      _goodProbeRun         = 0U;
+  uint32_t                     _quarantineCount      = 0U;
+
+  /* Written only by admit() */
+  uint16_t                     _probeCountdown       = 0U;
+  uint32_t                     _skippedTransferCount = 0U;
+
+  /*-- Private Prototypes -----------------------------------------------------------*/
+
+  static constexpr uint32_t windowMask(uint8_t windowLength)
+  {
+    return ((windowLength >= 32U) ? UINT32_MAX : ((1UL << windowLength) - 1U));
+  }
+
+};
+
+
+#endif /* __deviceHealth_H */
+
+/**
+  * @}End of File
+  */
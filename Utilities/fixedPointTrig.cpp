@@ -0,0 +1,235 @@
+/**
+  ******************************************************************************
+  * @file    fixedPointTrig.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains constants, variables, and function definitions
+  *          for fixed-point sine/cosine lookup used in motor commutation.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "fixedPointTrig.hpp"
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+/* Each quadrant is split into 256 table segments, leaving 6 bits of the angle for interpolation */
+const uint8_t  QUARTER_TABLE_INDEX_SHIFT = 6U;
+const uint16_t QUARTER_TABLE_FRACTION    = (1U << QUARTER_TABLE_INDEX_SHIFT) - 1U;
+const uint16_t QUARTER_TABLE_SEGMENTS    = 256U;
+
+const uint8_t  QUADRANT_SHIFT            = 14U;
+const uint8_t  QUADRANT_MIRROR           = 0x1U;
+const uint8_t  QUADRANT_NEGATE           = 0x2U;
+
+/* sin(index * pi / 512) for index 0 - 256, in Q15 */
+const int16_t QUARTER_SINE_Q15[QUARTER_TABLE_SEGMENTS + 1U] =
+{
+      0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,
+   2410,  2611,  2811,  3012,  3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,
+   4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,  6393,  6590,  6786,  6983,
+   7179,  7375,  7571,  7767,  7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+   9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605,
+  11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+  14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269, 15446, 15623, 15800, 15976,
+  16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+  18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000,
+  20159, 20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+  22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170, 23311, 23452, 23592,
+  23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+  25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674,
+  26790, 26905, 27019, 27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+  28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085, 29177,
+  29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+  30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050,
+  31113, 31176, 31237, 31297, 31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+  31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250,
+  32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+  32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752,
+  32757, 32761, 32765, 32766, 32767
+};
+
+/* sin(index * pi / 512) for index 0 - 256, in Q31 */
+const int32_t QUARTER_SINE_Q31[QUARTER_TABLE_SEGMENTS + 1U] =
+{
+           0,   13176712,   26352928,   39528151,   52701887,   65873638,
+    79042909,   92209205,  105372028,  118530885,  131685278,  144834714,
+   157978697,  171116732,  184248325,  197372981,  210490206,  223599506,
+   236700388,  249792358,  262874923,  275947592,  289009871,  302061269,
+   315101294,  328129457,  341145265,  354148229,  367137860,  380113669,
+   393075166,  406021864,  418953276,  431868915,  444768293,  457650927,
+   470516330,  483364019,  496193509,  509004318,  521795963,  534567963,
+   547319836,  560051103,  572761285,  585449903,  598116478,  610760535,
+   623381597,  635979190,  648552837,  661102068,  673626408,  686125386,
+   698598533,  711045377,  723465451,  735858287,  748223418,  760560379,
+   772868706,  785147934,  797397602,  809617248,  821806413,  833964637,
+   846091463,  858186434,  870249095,  882278991,  894275670,  906238681,
+   918167571,  930061894,  941921200,  953745043,  965532978,  977284561,
+   988999351, 1000676905, 1012316784, 1023918549, 1035481765, 1047005996,
+  1058490807, 1069935767, 1081340445, 1092704410, 1104027236, 1115308496,
+  1126547765, 1137744620, 1148898640, 1160009404, 1171076495, 1182099495,
+  1193077990, 1204011566, 1214899812, 1225742318, 1236538675, 1247288477,
+  1257991319, 1268646799, 1279254515, 1289814068, 1300325059, 1310787095,
+  1321199780, 1331562722, 1341875532, 1352137822, 1362349204, 1372509294,
+  1382617710, 1392674071, 1402677999, 1412629117, 1422527050, 1432371426,
+  1442161874, 1451898025, 1461579513, 1471205973, 1480777044, 1490292364,
+  1499751575, 1509154322, 1518500249, 1527789006, 1537020243, 1546193612,
+  1555308767, 1564365366, 1573363067, 1582301533, 1591180425, 1599999410,
+  1608758157, 1617456334, 1626093615, 1634669675, 1643184190, 1651636840,
+  1660027308, 1668355276, 1676620431, 1684822463, 1692961061, 1701035921,
+  1709046738, 1716993211, 1724875039, 1732691927, 1740443580, 1748129706,
+  1755750016, 1763304223, 1770792043, 1778213194, 1785567395, 1792854372,
+  1800073848, 1807225552, 1814309215, 1821324571, 1828271355, 1835149305,
+  1841958164, 1848697673, 1855367580, 1861967633, 1868497585, 1874957188,
+  1881346201, 1887664382, 1893911493, 1900087300, 1906191569, 1912224072,
+  1918184580, 1924072870, 1929888719, 1935631909, 1941302224, 1946899450,
+  1952423376, 1957873795, 1963250500, 1968553291, 1973781966, 1978936330,
+  1984016188, 1989021349, 1993951624, 1998806828, 2003586778, 2008291295,
+  2012920200, 2017473320, 2021950483, 2026351521, 2030676268, 2034924561,
+  2039096240, 2043191149, 2047209132, 2051150040, 2055013722, 2058800035,
+  2062508835, 2066139982, 2069693341, 2073168776, 2076566159, 2079885359,
+  2083126253, 2086288719, 2089372637, 2092377891, 2095304369, 2098151959,
+  2100920555, 2103610053, 2106220351, 2108751351, 2111202958, 2113575079,
+  2115867625, 2118080510, 2120213650, 2122266966, 2124240379, 2126133816,
+  2127947205, 2129680479, 2131333571, 2132906419, 2134398965, 2135811152,
+  2137142926, 2138394239, 2139565042, 2140655292, 2141664947, 2142593970,
+  2143442325, 2144209981, 2144896909, 2145503082, 2146028479, 2146473079,
+  2146836865, 2147119824, 2147321945, 2147443221, 2147483647
+};
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/**
+  * @brief  Folds a full-turn angle onto the first quadrant of the sine table
+  *
+  * @param  angle:    Angle as a 16-bit fraction of a turn
+  *
+  * @param  index:    Table segment the folded angle falls in
+  *
+  * @param  fraction: Position within the segment, 0 - 63
+  *
+  * @retval bool: True if the sine is negative in this quadrant
+  */
+static inline bool foldToFirstQuadrant(uint16_t angle, uint16_t* index, uint16_t* fraction)
+{
+  uint8_t  quadrant = static_cast<uint8_t>(angle >> QUADRANT_SHIFT);
+  uint16_t phase    = angle & (ANGLE_QUARTER_TURN - 1U);
+
+  /* Second and fourth quadrants run the table backwards - a phase of exactly a quarter turn lands on the last entry */
+  if ((quadrant & QUADRANT_MIRROR) != 0U)
+  {
+    phase = ANGLE_QUARTER_TURN - phase;
+  }
+
+  *index    = phase >> QUARTER_TABLE_INDEX_SHIFT;
+  *fraction = phase &  QUARTER_TABLE_FRACTION;
+
+  return ((quadrant & QUADRANT_NEGATE) != 0U);
+}
+
+
+/**
+  * @brief  Interpolated sine from the Q15 quarter-wave table
+  *
+  * @param  angle: Angle as a 16-bit fraction of a turn
+  *
+  * @retval Sine of the angle in Q15
+  */
+static inline int16_t sineQ15(uint16_t angle)
+{
+  uint16_t index;
+  uint16_t fraction;
+  bool     negative = foldToFirstQuadrant(angle, &index, &fraction);
+
+  /* The last entry has a zero fraction, so only step to the next entry when there is something to interpolate */
+  int32_t lower = QUARTER_SINE_Q15[index];
+  int32_t upper = QUARTER_SINE_Q15[index + ((fraction != 0U) ? 1U : 0U)];
+  int32_t value = lower + (((upper - lower) * static_cast<int32_t>(fraction)) >> QUARTER_TABLE_INDEX_SHIFT);
+
+  return (static_cast<int16_t>(negative ? -value : value));
+}
+
+
+/**
+  * @brief  Interpolated sine from the Q31 quarter-wave table
+  *
+  * @param  angle: Angle as a 16-bit fraction of a turn
+  *
+  * @retval Sine of the angle in Q31
+  */
+static inline int32_t sineQ31(uint16_t angle)
+{
+  uint16_t index;
+  uint16_t fraction;
+  bool     negative = foldToFirstQuadrant(angle, &index, &fraction);
+
+  int64_t lower = QUARTER_SINE_Q31[index];
+  int64_t upper = QUARTER_SINE_Q31[index + ((fraction != 0U) ? 1U : 0U)];
+  int64_t value = lower + (((upper - lower) * static_cast<int64_t>(fraction)) >> QUARTER_TABLE_INDEX_SHIFT);
+
+  return (static_cast<int32_t>(negative ? -value : value));
+}
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/**
+  * @brief  Quarter-wave table sine and cosine with linear interpolation
+  *
+  * @param  angle: Angle as a 16-bit fraction of a turn
+  *
+  * @retval SinCosQ15_t: Sine and cosine of the angle in Q15
+  */
+SinCosQ15_t sinCosQ15(uint16_t angle)
+{
+  SinCosQ15_t result = { .sine   = sineQ15(angle),
+                         .cosine = sineQ15(static_cast<uint16_t>(angle + ANGLE_QUARTER_TURN))
+                       };
+
+  return (result);
+}
+
+
+/**
+  * @brief  Quarter-wave table sine and cosine with linear interpolation
+  *
+  * @note   Output is Q31 but accuracy is bounded by the interpolation error, roughly 2^-17
+  *
+  * @param  angle: Angle as a 16-bit fraction of a turn
+  *
+  * @retval SinCosQ31_t: Sine and cosine of the angle in Q31
+  */
+SinCosQ31_t sinCosQ31(uint16_t angle)
+{
+  SinCosQ31_t result = { .sine   = sineQ31(angle),
+                         .cosine = sineQ31(static_cast<uint16_t>(angle + ANGLE_QUARTER_TURN))
+                       };
+
+  return (result);
+}
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    fixedPointTrig.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and function prototypes
+  *          for fixed-point sine/cosine lookup used in motor commutation.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __fixedPointTrig_H
+#define __fixedPointTrig_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/* Angles are unsigned 16-bit binary fractions of a turn - 0x10000 is 2*pi, so wrap is free */
+const uint8_t  ANGLE_RESOLUTION_BITS = 16U;
+const uint16_t ANGLE_QUARTER_TURN    = 0x4000U;
+
+/*************************************************************************************/
+/* TYPEDEFS                                                                          */
+/*************************************************************************************/
+
+typedef struct
+{
+  int16_t sine;
+  int16_t cosine;
+
+} SinCosQ15_t;
+
+
+typedef struct
+{
+  int32_t sine;
+  int32_t cosine;
+
+} SinCosQ31_t;
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DECLARANTIONS                                                     */
+/*************************************************************************************/
+
+SinCosQ15_t sinCosQ15(uint16_t angle);
+
+SinCosQ31_t sinCosQ31(uint16_t angle);
+
+
+#endif /* __fixedPointTrig_H */
+
+/**
+  * @}End of File
+  */
+
+
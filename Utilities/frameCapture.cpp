@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    frameCapture.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains constants, variables, and function definitions
+  *          for recording raw SPI frames into a ring buffer for later replay.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "frameCapture.hpp"
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+FrameCapture::FrameCapture(FrameCaptureRecord_t* records, uint16_t capacity)
+{
+  _records  = records;
+  _capacity = capacity;
+}
+
+
+/**
+  * @brief  Appends a frame, overwriting the oldest record once the ring is full
+  *
+  * @param  deviceID:  Chip select derived device ID, see CHIP_SELECT_DEVICE_ID
+  *
+  * @param  timestamp: Cycle count at chip select assertion
+  *
+  * @param  frame:     Received bytes
+  *
+  * @param  length:    Number of received bytes - truncated to FRAME_CAPTURE_MAX_FRAME_SIZE
+  *
+  * @retval None
+  */
+void FrameCapture::append(uint8_t deviceID, uint32_t timestamp, const uint8_t* frame, uint32_t length)
+{
+  if ((_records == NULL) || (_capacity == 0U))
+  {
+    return;
+  }
+
+  FrameCaptureRecord_t& record = _records[_writeIndex];
+
+  record.timestamp = timestamp;
+  record.deviceID  = deviceID;
+  record.length    = static_cast<uint8_t>((length < FRAME_CAPTURE_MAX_FRAME_SIZE) ? length : FRAME_CAPTURE_MAX_FRAME_SIZE);
+
+  for (uint8_t byte = 0U; byte < record.length; byte++)
+  {
+    record.frame[byte] = frame[byte];
+  }
+
+  _writeIndex = static_cast<uint16_t>((_writeIndex + 1U) % _capacity);
+
+  if (_recordCount < _capacity) _recordCount++;
+  else                          _overwritten++;
+}
+
+
+/**
+  * @brief   Serialises the captured records, oldest first, into the dump format
+  *
+  * @warning Detach the capture from its bus first - the ring is not locked against the ISR
+  *
+  * @param   output:       Destination buffer
+  *
+  * @param   outputLength: Size of the destination buffer
+  *
+  * @retval  uint32_t: Bytes written - only whole records are written, 0 if the header does not fit
+  */
+uint32_t FrameCapture::dump(uint8_t* output, uint32_t outputLength)
+{
+  if ((output == NULL) || (outputLength < FRAME_CAPTURE_HEADER_SIZE))
+  {
+    return (0U);
+  }
+
+  output[0] = FRAME_CAPTURE_MAGIC_0;
+  output[1] = FRAME_CAPTURE_MAGIC_1;
+  output[2] = FRAME_CAPTURE_FORMAT_VERSION;
+  output[3] = 0U;
+
+  uint32_t written     = FRAME_CAPTURE_HEADER_SIZE;
+  uint16_t oldestIndex = static_cast<uint16_t>((_writeIndex + _capacity - _recordCount) % _capacity);
+
+  for (uint16_t recordNumber = 0U; recordNumber < _recordCount; recordNumber++)
+  {
+    const FrameCaptureRecord_t& record = _records[(oldestIndex + recordNumber) % _capacity];
+
+    if ((outputLength - written) < static_cast<uint32_t>(FRAME_CAPTURE_RECORD_HEADER_SIZE + record.length))
+    {
+      break;
+    }
+
+    uint8_t* recordOut = &output[written];
+
+    recordOut[FRAME_CAPTURE_OFFSET_DEVICE_ID]      = record.deviceID;
+    recordOut[FRAME_CAPTURE_OFFSET_LENGTH]         = record.length;
+    recordOut[FRAME_CAPTURE_OFFSET_TIMESTAMP]      = static_cast<uint8_t>(record.timestamp);
+    recordOut[FRAME_CAPTURE_OFFSET_TIMESTAMP + 1U] = static_cast<uint8_t>(record.timestamp >> BITS_IN_A_BYTE);
+    recordOut[FRAME_CAPTURE_OFFSET_TIMESTAMP + 2U] = static_cast<uint8_t>(record.timestamp >> (2U * BITS_IN_A_BYTE));
+    recordOut[FRAME_CAPTURE_OFFSET_TIMESTAMP + 3U] = static_cast<uint8_t>(record.timestamp >> (3U * BITS_IN_A_BYTE));
+
+    for (uint8_t byte = 0U; byte < record.length; byte++)
+    {
+      recordOut[FRAME_CAPTURE_OFFSET_FRAME + byte] = record.frame[byte];
+    }
+
+    written += FRAME_CAPTURE_RECORD_HEADER_SIZE + record.length;
+  }
+
+  return (written);
+}
+
+
+void FrameCapture::clear(void)
+{
+  _writeIndex  = 0U;
+  _recordCount = 0U;
+  _overwritten = 0U;
+}
+
+
+uint32_t FrameCapture::getOverwrittenCount(void)
+{
+  return (_overwritten);
+}
+
+
+/**
+  * @}End of File
+  */
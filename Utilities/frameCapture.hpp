@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    frameCapture.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and function prototypes
+  *          for recording raw SPI frames into a ring buffer for later replay.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __frameCapture_H
+#define __frameCapture_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include "utilities.hpp"
+#include "frameCaptureFormat.hpp"
+
+/*************************************************************************************/
+/* TYPEDEFS                                                                          */
+/*************************************************************************************/
+
+typedef struct
+{
+  uint32_t timestamp;
+  uint8_t  deviceID;
+  uint8_t  length;
+  uint8_t  frame[FRAME_CAPTURE_MAX_FRAME_SIZE];
+
+} FrameCaptureRecord_t;
+
+/*************************************************************************************/
+/* INLINE FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/* Identifies a device by its chip select line - unique on the MCU without any registration */
+static inline uint8_t CHIP_SELECT_DEVICE_ID(GPIO_TypeDef* csPort, uint16_t csPin)
+{
+  const uint32_t GPIO_PORT_STRIDE = GPIOB_BASE - GPIOA_BASE;
+
+  uint8_t portIndex = static_cast<uint8_t>((reinterpret_cast<uintptr_t>(csPort) - GPIOA_BASE) / GPIO_PORT_STRIDE);
+  uint8_t pinIndex  = static_cast<uint8_t>(__builtin_ctz(csPin));
+
+  return (static_cast<uint8_t>((portIndex << 4U) | pinIndex));
+}
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class FrameCapture
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  FrameCapture(FrameCaptureRecord_t* records, uint16_t capacity);
+
+  void append(uint8_t deviceID, uint32_t timestamp, const uint8_t* frame, uint32_t length);
+
+  uint32_t dump(uint8_t* output, uint32_t outputLength);
+
+  void clear(void);
+
+  uint32_t getOverwrittenCount(void);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  FrameCaptureRecord_t* _records;
+  uint16_t              _capacity;
+  uint16_t              _writeIndex  = 0U;
+  uint16_t              _recordCount = 0U;
+  uint32_t              _overwritten = 0U;
+
+};
+
+
+#endif /* __frameCapture_H */
+
+/**
+  * @}End of File
+  */
+
+
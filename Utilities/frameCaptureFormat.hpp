@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    frameCaptureFormat.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines describing the raw SPI frame capture dump.
+  *          Kept free of HAL includes so host-side tools can share it with
+  *          the target capture.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __frameCaptureFormat_H
+#define __frameCaptureFormat_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/*
+ * Dump layout (little-endian):
+ *
+ *   [0]     magic 'R'
+ *   [1]     magic 'C'
+ *   [2]     format version
+ *   [3]     reserved, 0
+ *   [4..]   records, oldest first:
+ *             u8  device ID - (GPIO port index << 4) | chip select pin number
+ *             u8  frame length
+ *             u32 chip select cycle count
+ *             frame bytes as received
+ */
+
+const uint8_t FRAME_CAPTURE_MAGIC_0            = 'R';
+const uint8_t FRAME_CAPTURE_MAGIC_1            = 'C';
+const uint8_t FRAME_CAPTURE_FORMAT_VERSION     = 1U;
+
+const uint8_t FRAME_CAPTURE_HEADER_SIZE        = 4U;
+const uint8_t FRAME_CAPTURE_RECORD_HEADER_SIZE = 6U;
+
+/* Longer frames are truncated - enough for encoder reads, not for bulk transfers */
+const uint8_t FRAME_CAPTURE_MAX_FRAME_SIZE     = 8U;
+
+typedef enum: uint8_t
+{
+  FRAME_CAPTURE_OFFSET_DEVICE_ID = 0U,
+  FRAME_CAPTURE_OFFSET_LENGTH    = 1U,
+  FRAME_CAPTURE_OFFSET_TIMESTAMP = 2U,
+  FRAME_CAPTURE_OFFSET_FRAME     = 6U,
+} FrameCaptureRecordOffset_t;
+
+
+#endif /* __frameCaptureFormat_H */
+
+/**
+  * @}End of File
+  */
+
+
@@ -0,0 +1,138 @@
+/**
+  ******************************************************************************
+  * @file    linearityTable.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains constants, variables, and function definitions
+  *          for applying a per-unit linearity calibration to encoder positions.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "linearityTable.hpp"
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+int16_t LinearityTable::readEntry(uint16_t index)
+{
+  const uint8_t* entry = &_entries[index * CALIBRATION_ENTRY_SIZE];
+
+  return (static_cast<int16_t>(entry[0] | (entry[1] << BITS_IN_A_BYTE)));
+}
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/**
+  * @brief   Validates a calibration blob and attaches its entries to the table
+  *
+  * @warning The blob is used in place, not copied, so it must outlive the table. Load
+  *          before position fetches start - the ISR reads the table without locking.
+  *
+  * @param   calibrationBlob: Calibration blob as produced by the host fitting tool
+  *
+  * @param   length:          Length of the blob in bytes
+  *
+  * @retval  status_t: STATUS_ERROR if the blob is malformed or fitted for another resolution
+  */
+status_t LinearityTable::load(const uint8_t* calibrationBlob, uint32_t length)
+{
+  if ((calibrationBlob == NULL) || (length < CALIBRATION_HEADER_SIZE))
+  {
+    return (STATUS_ERROR);
+  }
+
+  uint8_t entriesLog2 = calibrationBlob[CALIBRATION_OFFSET_ENTRIES_LOG2];
+
+  if ((calibrationBlob[CALIBRATION_OFFSET_MAGIC_0]       != CALIBRATION_MAGIC_0)        ||
+      (calibrationBlob[CALIBRATION_OFFSET_MAGIC_1]       != CALIBRATION_MAGIC_1)        ||
+      (calibrationBlob[CALIBRATION_OFFSET_VERSION]       != CALIBRATION_FORMAT_VERSION) ||
+      (calibrationBlob[CALIBRATION_OFFSET_RESOLUTION]    != _positionResolution)        ||
+      (calibrationBlob[CALIBRATION_OFFSET_FRACTION_BITS] != CALIBRATION_FRACTION_BITS)  ||
+      (entriesLog2 < CALIBRATION_MIN_ENTRIES_LOG2)                                      ||
+      (entriesLog2 > CALIBRATION_MAX_ENTRIES_LOG2)                                      ||
+      (entriesLog2 > _positionResolution)                                                 )
+  {
+    return (STATUS_ERROR);
+  }
+
+  uint32_t entriesLength = (1UL << entriesLog2) * CALIBRATION_ENTRY_SIZE;
+
+  if (length < (CALIBRATION_HEADER_SIZE + entriesLength))
+  {
+    return (STATUS_ERROR);
+  }
+
+  uint16_t storedChecksum = static_cast<uint16_t>(calibrationBlob[CALIBRATION_OFFSET_CHECKSUM] |
+                                                  (calibrationBlob[CALIBRATION_OFFSET_CHECKSUM + 1U] << BITS_IN_A_BYTE));
+
+  if (calibrationChecksum(&calibrationBlob[CALIBRATION_HEADER_SIZE], entriesLength) != storedChecksum)
+  {
+    return (STATUS_ERROR);
+  }
+
+  _indexShift = _positionResolution - entriesLog2;
+  _indexMask  = static_cast<uint16_t>((1UL << entriesLog2) - 1U);
+  _entries    = &calibrationBlob[CALIBRATION_HEADER_SIZE];
+
+  return (STATUS_OK);
+}
+
+
+void LinearityTable::unload(void)
+{
+  _entries = NULL;
+}
+
+
+/**
+  * @brief  Applies the interpolated correction for a raw position
+  *
+  * @param  position: Raw position at the table's resolution
+  *
+  * @retval uint16_t: Corrected position, wrapped to one turn. Unchanged if no table is loaded.
+  */
+uint16_t LinearityTable::apply(uint16_t position)
+{
+  if (_entries == NULL)
+  {
+    return (position);
+  }
+
+  uint16_t index    = position >> _indexShift;
+  int32_t  fraction = position & ((1U << _indexShift) - 1U);
+
+  /* Correction error is periodic over a turn, so the last segment interpolates back to the first entry */
+  int32_t lower      = readEntry(index);
+  int32_t upper      = readEntry((index + 1U) & _indexMask);
+  int32_t correction = lower + (((upper - lower) * fraction) >> _indexShift);
+
+  /* Round the fractional correction to the nearest count */
+  int32_t corrected  = position + ((correction + (1 << (CALIBRATION_FRACTION_BITS - 1U))) >> CALIBRATION_FRACTION_BITS);
+
+  return (static_cast<uint16_t>(corrected) & _positionMask);
+}
+
+
+/**
+  * @}End of File
+  */
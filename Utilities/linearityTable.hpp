@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file    linearityTable.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and function prototypes
+  *          for applying a per-unit linearity calibration to encoder positions.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __linearityTable_H
+#define __linearityTable_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include "utilities.hpp"
+#include "calibrationFormat.hpp"
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class LinearityTable
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  constexpr LinearityTable(uint8_t positionResolution):
+  _positionResolution(positionResolution), _positionMask(static_cast<uint16_t>((1UL << positionResolution) - 1U))
+  {}
+
+  status_t load(const uint8_t* calibrationBlob, uint32_t length);
+
+  void unload(void);
+
+  uint16_t apply(uint16_t position);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  const uint8_t* _entries = NULL;
+
+  uint8_t        _positionResolution;
+  uint16_t       _positionMask;
+  uint8_t        _indexShift         = 0U;
+  uint16_t       _indexMask          = 0U;
+
+  /*-- Private Prototypes -----------------------------------------------------------*/
+
+  int16_t readEntry(uint16_t index);
+
+};
+
+
+#endif /* __linearityTable_H */
+
+/**
+  * @}End of File
+  */
+
+
@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file    orbisBatchDecode.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the batch Orbis frame decoder. The CRC is linear, so
+  *          a 2-byte payload's CRC is the XOR of four per-nibble contributions
+  *          which SSSE3/AVX2 byte shuffles look up 16 or 32 frames at a time.
+  *          The vector path is selected at compile time (-mssse3, -mavx2 or
+  *          -march=native); without either, every frame takes the scalar path.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "orbisBatchDecode.hpp"
+#include "CRC8.hpp"
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+/*************************************************************************************/
+/* PRIVATE CONSTANTS                                                                 */
+/*************************************************************************************/
+
+static const uint8_t BATCH_BITS_IN_BYTE  = 8U;
+static const uint8_t BATCH_NIBBLE_BITS   = 4U;
+static const uint8_t BATCH_NIBBLE_MASK   = 0x0FU;
+
+/* The driver's own table, so batch results match it bit for bit */
+static constexpr CRC8 BATCH_CRC          = CRC8(ORBIS_BATCH_CRC_POLYNOMIAL);
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+static const uint8_t VECTOR_FRAMES       = 16U;
+
+/* Shuffle masks gathering byte [output] of 16 packed frames out of 16-byte input vector [input] */
+alignas(16) static const int8_t DEINTERLEAVE_MASKS[ORBIS_BATCH_FRAME_SIZE][ORBIS_BATCH_FRAME_SIZE][VECTOR_FRAMES] =
+{
+  {
+    {  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1,  4,  7, 10, 13 },
+  },
+  {
+    {  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14 },
+  },
+  {
+    {  2,  5,  8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1,  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1 },
+    { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15 },
+  },
+};
+
+#endif
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+OrbisBatchDecoder::OrbisBatchDecoder(void)
+{
+  /* crc(b0, b1) = T[T[b0] ^ b1] = T[T[b0]] ^ T[b1], and each term splits the same way per nibble */
+  for (uint8_t nibble = 0U; nibble < NIBBLE_TABLE_SIZE; nibble++)
+  {
+    uint8_t highNibble = static_cast<uint8_t>(nibble << BATCH_NIBBLE_BITS);
+
+    _nibbleTables[NIBBLE_TABLE_BYTE_0_LOW][nibble]  = BATCH_CRC.getTableEntry(BATCH_CRC.getTableEntry(nibble));
+    _nibbleTables[NIBBLE_TABLE_BYTE_0_HIGH][nibble] = BATCH_CRC.getTableEntry(BATCH_CRC.getTableEntry(highNibble));
+    _nibbleTables[NIBBLE_TABLE_BYTE_1_LOW][nibble]  = BATCH_CRC.getTableEntry(nibble);
+    _nibbleTables[NIBBLE_TABLE_BYTE_1_HIGH][nibble] = BATCH_CRC.getTableEntry(highNibble);
+  }
+}
+
+
+/**
+  * @brief  Decodes packed frames into positions, raw status fields and CRC pass flags (1 pass, 0 fail)
+  *
+  * @note   Positions and statuses are decoded whether or not the CRC passes
+  */
+void OrbisBatchDecoder::decode(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass)
+{
+  uint32_t vectorFrames = decodeVector(frames, frameCount, positions, statuses, CRCPass);
+
+  decodeScalar(&frames[vectorFrames * ORBIS_BATCH_FRAME_SIZE], frameCount - vectorFrames,
+               &positions[vectorFrames], &statuses[vectorFrames], &CRCPass[vectorFrames]);
+}
+
+
+/**
+  * @brief  Decodes packed frames one at a time, the reference the vector path must match
+  */
+void OrbisBatchDecoder::decodeScalar(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass)
+{
+  for (uint32_t frame = 0U; frame < frameCount; frame++)
+  {
+    const uint8_t* bytes = &frames[frame * ORBIS_BATCH_FRAME_SIZE];
+    uint8_t        crc   = static_cast<uint8_t>(~BATCH_CRC.getTableEntry(BATCH_CRC.getTableEntry(bytes[0]) ^ bytes[1]));
+
+    positions[frame] = static_cast<uint16_t>(((bytes[0] << BATCH_BITS_IN_BYTE) | bytes[1]) >> ORBIS_BATCH_STATUS_BIT_SIZE);
+    statuses[frame]  = bytes[1] & ORBIS_BATCH_STATUS_MASK;
+    CRCPass[frame]   = (crc == bytes[2]) ? 1U : 0U;
+  }
+}
+
+
+const char* OrbisBatchDecoder::getImplementationName(void)
+{
+#if defined(__AVX2__)
+  return ("AVX2");
+#elif defined(__SSSE3__)
+  return ("SSSE3");
+#else
+  return ("scalar");
+#endif
+}
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/**
+  * @brief  Decodes as many whole vectors of frames as fit, returning the number of frames decoded
+  */
+#if defined(__AVX2__)
+
+uint32_t OrbisBatchDecoder::decodeVector(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass)
+{
+  const uint32_t FRAMES_PER_STEP = 2U * VECTOR_FRAMES;
+  const uint32_t LANE_BYTES      = VECTOR_FRAMES * ORBIS_BATCH_FRAME_SIZE;
+
+  __m256i masks[ORBIS_BATCH_FRAME_SIZE][ORBIS_BATCH_FRAME_SIZE];
+
+  for (uint8_t output = 0U; output < ORBIS_BATCH_FRAME_SIZE; output++)
+  {
+    for (uint8_t input = 0U; input < ORBIS_BATCH_FRAME_SIZE; input++)
+    {
+      masks[output][input] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(DEINTERLEAVE_MASKS[output][input])));
+    }
+  }
+
+  const __m256i byte0Low   = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_0_LOW])));
+  const __m256i byte0High  = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_0_HIGH])));
+  const __m256i byte1Low   = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_1_LOW])));
+  const __m256i byte1High  = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_1_HIGH])));
+  const __m256i nibbleMask = _mm256_set1_epi8(BATCH_NIBBLE_MASK);
+  const __m256i statusMask = _mm256_set1_epi8(ORBIS_BATCH_STATUS_MASK);
+  const __m256i one        = _mm256_set1_epi8(1);
+  const __m256i allOnes    = _mm256_set1_epi8(-1);
+
+  uint32_t frame = 0U;
+
+  for (; (frameCount - frame) >= FRAMES_PER_STEP; frame += FRAMES_PER_STEP)
+  {
+    const uint8_t* step = &frames[frame * ORBIS_BATCH_FRAME_SIZE];
+    __m256i        in[ORBIS_BATCH_FRAME_SIZE];
+    __m256i        bytes[ORBIS_BATCH_FRAME_SIZE];
+
+    /* low lane holds frames 0-15, high lane frames 16-31, so the 128-bit shuffles never cross lanes */
+    for (uint8_t input = 0U; input < ORBIS_BATCH_FRAME_SIZE; input++)
+    {
+      in[input] = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(&step[LANE_BYTES + (input * VECTOR_FRAMES)]),
+                                      reinterpret_cast<const __m128i*>(&step[input * VECTOR_FRAMES]));
+    }
+
+    for (uint8_t output = 0U; output < ORBIS_BATCH_FRAME_SIZE; output++)
+    {
+      bytes[output] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(in[0], masks[output][0]),
+                                                      _mm256_shuffle_epi8(in[1], masks[output][1])),
+                                      _mm256_shuffle_epi8(in[2], masks[output][2]));
+    }
+
+    __m256i crc = _mm256_xor_si256(
+                    _mm256_xor_si256(_mm256_shuffle_epi8(byte0Low,  _mm256_and_si256(bytes[0], nibbleMask)),
+                                     _mm256_shuffle_epi8(byte0High, _mm256_and_si256(_mm256_srli_epi16(bytes[0], BATCH_NIBBLE_BITS), nibbleMask))),
+                    _mm256_xor_si256(_mm256_shuffle_epi8(byte1Low,  _mm256_and_si256(bytes[1], nibbleMask)),
+                                     _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(bytes[1], BATCH_NIBBLE_BITS), nibbleMask))));
+
+    __m256i pass = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_xor_si256(crc, allOnes), bytes[2]), one);
+
+    /* byte 0 is the high half of the big-endian payload */
+    __m256i payloadLow  = _mm256_srli_epi16(_mm256_unpacklo_epi8(bytes[1], bytes[0]), ORBIS_BATCH_STATUS_BIT_SIZE);
+    __m256i payloadHigh = _mm256_srli_epi16(_mm256_unpackhi_epi8(bytes[1], bytes[0]), ORBIS_BATCH_STATUS_BIT_SIZE);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&positions[frame]),                 _mm256_permute2x128_si256(payloadLow, payloadHigh, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&positions[frame + VECTOR_FRAMES]), _mm256_permute2x128_si256(payloadLow, payloadHigh, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&statuses[frame]),                  _mm256_and_si256(bytes[1], statusMask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&CRCPass[frame]),                   pass);
+  }
+
+  return (frame);
+}
+
+#elif defined(__SSSE3__)
+
+uint32_t OrbisBatchDecoder::decodeVector(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass)
+{
+  __m128i masks[ORBIS_BATCH_FRAME_SIZE][ORBIS_BATCH_FRAME_SIZE];
+
+  for (uint8_t output = 0U; output < ORBIS_BATCH_FRAME_SIZE; output++)
+  {
+    for (uint8_t input = 0U; input < ORBIS_BATCH_FRAME_SIZE; input++)
+    {
+      masks[output][input] = _mm_load_si128(reinterpret_cast<const __m128i*>(DEINTERLEAVE_MASKS[output][input]));
+    }
+  }
+
+  const __m128i byte0Low   = _mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_0_LOW]));
+  const __m128i byte0High  = _mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_0_HIGH]));
+  const __m128i byte1Low   = _mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_1_LOW]));
+  const __m128i byte1High  = _mm_load_si128(reinterpret_cast<const __m128i*>(_nibbleTables[NIBBLE_TABLE_BYTE_1_HIGH]));
+  const __m128i nibbleMask = _mm_set1_epi8(BATCH_NIBBLE_MASK);
+  const __m128i statusMask = _mm_set1_epi8(ORBIS_BATCH_STATUS_MASK);
+  const __m128i one        = _mm_set1_epi8(1);
+  const __m128i allOnes    = _mm_set1_epi8(-1);
+
+  uint32_t frame = 0U;
+
+  for (; (frameCount - frame) >= VECTOR_FRAMES; frame += VECTOR_FRAMES)
+  {
+    const uint8_t* step = &frames[frame * ORBIS_BATCH_FRAME_SIZE];
+    __m128i        in[ORBIS_BATCH_FRAME_SIZE];
+    __m128i        bytes[ORBIS_BATCH_FRAME_SIZE];
+
+    for (uint8_t input = 0U; input < ORBIS_BATCH_FRAME_SIZE; input++)
+    {
+      in[input] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&step[input * VECTOR_FRAMES]));
+    }
+
+    for (uint8_t output = 0U; output < ORBIS_BATCH_FRAME_SIZE; output++)
+    {
+      bytes[output] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in[0], masks[output][0]),
+                                                _mm_shuffle_epi8(in[1], masks[output][1])),
+                                   _mm_shuffle_epi8(in[2], masks[output][2]));
+    }
+
+    __m128i crc = _mm_xor_si128(
+                    _mm_xor_si128(_mm_shuffle_epi8(byte0Low,  _mm_and_si128(bytes[0], nibbleMask)),
+                                  _mm_shuffle_epi8(byte0High, _mm_and_si128(_mm_srli_epi16(bytes[0], BATCH_NIBBLE_BITS), nibbleMask))),
+                    _mm_xor_si128(_mm_shuffle_epi8(byte1Low,  _mm_and_si128(bytes[1], nibbleMask)),
+                                  _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(bytes[1], BATCH_NIBBLE_BITS), nibbleMask))));
+
+    __m128i pass = _mm_and_si128(_mm_cmpeq_epi8(_mm_xor_si128(crc, allOnes), bytes[2]), one);
+
+    /* byte 0 is the high half of the big-endian payload */
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[frame]),     _mm_srli_epi16(_mm_unpacklo_epi8(bytes[1], bytes[0]), ORBIS_BATCH_STATUS_BIT_SIZE));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&positions[frame + 8]), _mm_srli_epi16(_mm_unpackhi_epi8(bytes[1], bytes[0]), ORBIS_BATCH_STATUS_BIT_SIZE));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&statuses[frame]),      _mm_and_si128(bytes[1], statusMask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&CRCPass[frame]),       pass);
+  }
+
+  return (frame);
+}
+
+#else
+
+uint32_t OrbisBatchDecoder::decodeVector(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass)
+{
+  (void)frames;
+  (void)frameCount;
+  (void)positions;
+  (void)statuses;
+  (void)CRCPass;
+
+  return (0U);
+}
+
+#endif
+
+
+/**
+  * @}End of File
+  */
@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    orbisBatchDecode.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines and the class declaration for decoding
+  *          large arrays of recorded Orbis position frames at once. Kept
+  *          free of HAL includes so host-side tools can use it.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __orbisBatchDecode_H
+#define __orbisBatchDecode_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/*
+ * Frames are packed back to back, 3 bytes each, exactly as received:
+ *
+ *   [0]  position bits 13..6
+ *   [1]  position bits 5..0, status bits 1..0
+ *   [2]  inverted CRC-8 (polynomial 0x97) of bytes 0 and 1
+ *
+ * Status is the raw 2-bit field, 0b11 meaning no error or warning.
+ */
+
+const uint8_t ORBIS_BATCH_FRAME_SIZE          = 3U;
+const uint8_t ORBIS_BATCH_CRC_POLYNOMIAL      = 0x97U;
+const uint8_t ORBIS_BATCH_STATUS_MASK         = 0x03U;
+const uint8_t ORBIS_BATCH_STATUS_BIT_SIZE     = 2U;
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class OrbisBatchDecoder
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  OrbisBatchDecoder(void);
+
+  void decode(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass);
+
+  void decodeScalar(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass);
+
+  static const char* getImplementationName(void);
+
+  private:
+
+  /*-- Private Constants ------------------------------------------------------------*/
+
+  static const uint8_t  NIBBLE_TABLE_SIZE = 16U;
+
+  typedef enum: uint8_t
+  {
+    NIBBLE_TABLE_BYTE_0_LOW  = 0U,
+    NIBBLE_TABLE_BYTE_0_HIGH = 1U,
+    NIBBLE_TABLE_BYTE_1_LOW  = 2U,
+    NIBBLE_TABLE_BYTE_1_HIGH = 3U,
+    NUMBER_OF_NIBBLE_TABLES
+  } NibbleTable_t;
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  /* CRC contribution of each nibble of each payload byte, one 16-byte shuffle table apiece */
+  alignas(16) uint8_t _nibbleTables[NUMBER_OF_NIBBLE_TABLES][NIBBLE_TABLE_SIZE] = {{0U}};
+
+  /*-- Private Prototypes -----------------------------------------------------------*/
+
+  uint32_t decodeVector(const uint8_t* frames, uint32_t frameCount, uint16_t* positions, uint8_t* statuses, uint8_t* CRCPass);
+
+};
+
+
+#endif /* __orbisBatchDecode_H */
+
+/**
+  * @}End of File
+  */
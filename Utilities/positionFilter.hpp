@@ -0,0 +1,252 @@
+/**
+  ******************************************************************************
+  * @file    positionFilter.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains the fixed-point position filter stages and the
+  *          compile-time chain which runs them on each sample in the encoder's
+  *          completion ISR. All stages handle the wrap at one turn.
+  *
+  *          Example - glitch rejection, a 512 count step limit which gives up
+  *          after 3 rejections, then smoothing with a 1/4 gain:
+  *
+  *            PositionFilterChain<MedianOf3Filter<14>,
+  *                                MaxStepFilter<14, 512, 3>,
+  *                                FirstOrderIIRFilter<14, 2>> orbisFilter;
+  *
+  *            encoder.attachPositionFilter(&orbisFilter);
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __positionFilter_H
+#define __positionFilter_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include <tuple>
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/* Signed shortest step from one position to another at a given resolution, +/- half a turn */
+template<uint8_t RESOLUTION>
+static inline int32_t wrappedStep(uint32_t fromPosition, uint32_t toPosition)
+{
+  const uint8_t signShift = 32U - RESOLUTION;
+
+  return (static_cast<int32_t>((toPosition - fromPosition) << signShift) >> signShift);
+}
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+/* What the encoder holds - one virtual call per sample, the stages inside are inlined */
+class PositionFilter
+{
+
+  public:
+
+  virtual ~PositionFilter() {};
+
+  virtual uint16_t apply(uint16_t position) = 0;
+
+  virtual void reset(void) = 0;
+
+};
+
+
+/* Output is the median of the last three samples, so any single-sample spike is dropped for one sample of delay */
+template<uint8_t RESOLUTION>
+class MedianOf3Filter
+{
+
+  public:
+
+  uint16_t apply(uint16_t position)
+  {
+    if (!_primed)
+    {
+      _previous[0] = position;
+      _previous[1] = position;
+      _primed      = true;
+    }
+
+    /* Take the median of the steps relative to the newest sample so it holds across the wrap */
+    int32_t stepA = wrappedStep<RESOLUTION>(position, _previous[0]);
+    int32_t stepB = wrappedStep<RESOLUTION>(position, _previous[1]);
+
+    int32_t low   = (stepA < stepB) ? stepA : stepB;
+    int32_t high  = (stepA < stepB) ? stepB : stepA;
+    int32_t step  = (high < 0) ? high : ((low > 0) ? low : 0);
+
+    _previous[1]  = _previous[0];
+    _previous[0]  = position;
+
+    return (static_cast<uint16_t>((position + step) & POSITION_MASK));
+  }
+
+  void reset(void)
+  {
+    _primed = false;
+  }
+
+  private:
+
+  static const uint32_t POSITION_MASK = (1UL << RESOLUTION) - 1U;
+
+  uint16_t _previous[2] = {0U, 0U};
+  bool     _primed      = false;
+
+};
+
+
+/* Holds the last output while a sample jumps further than MAX_STEP, accepting the new
+ * position after RESYNC_COUNT consecutive rejections in case the jump was real */
+template<uint8_t RESOLUTION, uint16_t MAX_STEP, uint8_t RESYNC_COUNT>
+class MaxStepFilter
+{
+
+  public:
+
+  static_assert(MAX_STEP < (1UL << (RESOLUTION - 1U)), "Step limit must be under half a turn");
+
+  uint16_t apply(uint16_t position)
+  {
+    int32_t step = wrappedStep<RESOLUTION>(_output, position);
+
+    if (!_primed || ((step <= MAX_STEP) && (step >= -static_cast<int32_t>(MAX_STEP))) || (_rejectedCount >= RESYNC_COUNT))
+    {
+      _output        = position;
+      _rejectedCount = 0U;
+      _primed        = true;
+    }
+    else
+    {
+      _rejectedCount++;
+      _rejectedTotal++;
+    }
+
+    return (_output);
+  }
+
+  void reset(void)
+  {
+    _primed        = false;
+    _rejectedCount = 0U;
+  }
+
+  uint32_t getRejectedCount(void)
+  {
+    return (_rejectedTotal);
+  }
+
+  private:
+
+  uint16_t _output        = 0U;
+  uint8_t  _rejectedCount = 0U;
+  uint32_t _rejectedTotal = 0U;
+  bool     _primed        = false;
+
+};
+
+
+/* y += (x - y) / 2^GAIN_SHIFT, with 8 fraction bits carried between samples so small steps are not lost */
+template<uint8_t RESOLUTION, uint8_t GAIN_SHIFT>
+class FirstOrderIIRFilter
+{
+
+  public:
+
+  uint16_t apply(uint16_t position)
+  {
+    uint32_t input = static_cast<uint32_t>(position) << FRACTION_BITS;
+
+    if (!_primed)
+    {
+      _state  = input;
+      _primed = true;
+    }
+
+    _state = (_state + static_cast<uint32_t>(wrappedStep<STATE_RESOLUTION>(_state, input) >> GAIN_SHIFT)) & STATE_MASK;
+
+    return (static_cast<uint16_t>(((_state + FRACTION_HALF) & STATE_MASK) >> FRACTION_BITS));
+  }
+
+  void reset(void)
+  {
+    _primed = false;
+  }
+
+  private:
+
+  static const uint8_t  FRACTION_BITS    = 8U;
+  static const uint8_t  STATE_RESOLUTION = RESOLUTION + FRACTION_BITS;
+  static const uint32_t STATE_MASK       = (1UL << STATE_RESOLUTION) - 1U;
+  static const uint32_t FRACTION_HALF    = 1UL << (FRACTION_BITS - 1U);
+
+  static_assert((GAIN_SHIFT > 0U) && (GAIN_SHIFT < STATE_RESOLUTION), "Gain must be below one");
+
+  uint32_t _state  = 0U;
+  bool     _primed = false;
+
+};
+
+
+/* Runs each stage in order on every sample - the chain is fixed at compile time so the stages inline */
+template<typename... STAGES>
+class PositionFilterChain:
+public PositionFilter
+{
+
+  public:
+
+  virtual uint16_t apply(uint16_t position) final
+  {
+    std::apply([&position](STAGES&... stage) { ((position = stage.apply(position)), ...); }, _stages);
+
+    return (position);
+  }
+
+  virtual void reset(void) final
+  {
+    std::apply([](STAGES&... stage) { (stage.reset(), ...); }, _stages);
+  }
+
+  /* Access to a stage, e.g. to read a MaxStepFilter's rejection count */
+  template<uint8_t INDEX>
+  auto& getStage(void)
+  {
+    return (std::get<INDEX>(_stages));
+  }
+
+  private:
+
+  std::tuple<STAGES...> _stages;
+
+};
+
+
+#endif /* __positionFilter_H */
+
+/**
+  * @}End of File
+  */
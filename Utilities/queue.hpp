@@ -41,7 +41,7 @@
 /* TEMPLATE IMPLEMENTATIONS                                                          */
 /*************************************************************************************/
 
-template<typename elementType_t>
+template<typename elementType_t, int8_t STATIC_QUEUE_SIZE = 10>
 class QUEUE
 {
   public:
@@ -57,12 +57,7 @@ class QUEUE
 
   /* Public Prototypes --------------------------------------------------------------*/
 
-  QUEUE(void)
-  {
-    _frontIndex   =  0U;
-    _rearIndex    =  0U;
-    _elementCount =  0;
-  }
+  constexpr QUEUE(void) {}
 
 
   int8_t getSize(void)
@@ -96,6 +91,45 @@ class QUEUE
   }
 
 
+  QUEUE::return_t peek(int8_t position)
+  {
+    QUEUE::return_t queueReturn;
+
+    if((position < 0) || (position >= _elementCount))
+    {
+      queueReturn.status = STATUS_ERROR;
+      return (queueReturn);
+    }
+
+    else
+    {
+      queueReturn.data   = _elementArray[_frontIndex + position];
+      queueReturn.status = STATUS_OK;
+      return (queueReturn);
+    }
+  }
+
+
+  status_t moveToFront(int8_t position)
+  {
+    if((position < 0) || (position >= _elementCount))
+    {
+      return (STATUS_ERROR);
+    }
+
+    elementType_t element = _elementArray[_frontIndex + position];
+
+    for (int8_t index = position; index > 0; index--)
+    {
+      _elementArray[_frontIndex + index] = _elementArray[_frontIndex + index - 1];
+    }
+
+    _elementArray[_frontIndex] = element;
+
+    return (STATUS_OK);
+  }
+
+
   status_t push(elementType_t element)
   {
     if(_elementCount >= STATIC_QUEUE_SIZE)
@@ -137,14 +171,14 @@ class QUEUE
 
   /* Private Constants ---------------------------------------------------------------*/
 
-  static const int8_t STATIC_QUEUE_SIZE = 10;
+  static_assert(STATIC_QUEUE_SIZE > 0, "Queue must hold at least one element");
 
   /* Private Variables ---------------------------------------------------------------*/
 
-  elementType_t _elementArray[STATIC_QUEUE_SIZE];
-  uint8_t       _frontIndex;
-  uint8_t       _rearIndex;
-  int8_t        _elementCount;
+  elementType_t _elementArray[STATIC_QUEUE_SIZE] = {};
+  uint8_t       _frontIndex                      = 0U;
+  uint8_t       _rearIndex                       = 0U;
+  int8_t        _elementCount                    = 0;
 
   /* Private Prototypes --------------------------------------------------------------*/
 
@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file    telemetryEncoder.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains constants, variables, and function definitions
+  *          for compressing encoder samples into a compact telemetry stream.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "telemetryEncoder.hpp"
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+void TelemetryEncoder::writeKeyframe(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp)
+{
+  uint8_t* record = &_buffers[_activeBuffer][_activeLength];
+
+  record[0] = TELEMETRY_RECORD_KEYFRAME;
+  record[1] = static_cast<uint8_t>(position);
+  record[2] = static_cast<uint8_t>(position >> BITS_IN_A_BYTE);
+  record[3] = status;
+  record[4] = deviceStatus;
+  record[5] = static_cast<uint8_t>(timestamp);
+  record[6] = static_cast<uint8_t>(timestamp >> BITS_IN_A_BYTE);
+  record[7] = static_cast<uint8_t>(timestamp >> (2U * BITS_IN_A_BYTE));
+  record[8] = static_cast<uint8_t>(timestamp >> (3U * BITS_IN_A_BYTE));
+  record[9] = _positionResolution;
+
+  _activeLength      += TELEMETRY_KEYFRAME_SIZE;
+  _lastTimestampDelta = 0U;
+  _samplesSinceKey    = 0U;
+}
+
+
+void TelemetryEncoder::writeDelta(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp)
+{
+  uint8_t* record = &_buffers[_activeBuffer][_activeLength];
+
+  /* Sign extend the wrapped difference so crossing zero costs a small delta rather than a full turn */
+  int32_t positionDelta = static_cast<int16_t>(static_cast<uint16_t>(position - _lastPosition) << _positionShift) >> _positionShift;
+
+  /* Sampling is near periodic, so the change in interval is far smaller than the interval itself */
+  uint32_t timestampDelta = timestamp - _lastTimestamp;
+  int32_t  deltaOfDelta   = static_cast<int32_t>(timestampDelta - _lastTimestampDelta);
+
+  bool     statusChanged  = (status != _lastStatus) || (deviceStatus != _lastDeviceStatus);
+  uint32_t header         = (zigzagEncode(positionDelta) << TELEMETRY_RECORD_TYPE_BITS) |
+                            (statusChanged ? TELEMETRY_RECORD_DELTA_STATUS : TELEMETRY_RECORD_DELTA);
+
+  uint8_t length = varintWrite(record, header);
+  length        += varintWrite(&record[length], zigzagEncode(deltaOfDelta));
+
+  if (statusChanged)
+  {
+    record[length++] = status;
+    record[length++] = deviceStatus;
+  }
+
+  _activeLength      += length;
+  _lastTimestampDelta = timestampDelta;
+  _samplesSinceKey++;
+}
+
+
+status_t TelemetryEncoder::swapBuffers(void)
+{
+  if (_bufferInFlight)
+  {
+    return (STATUS_ERROR);
+  }
+
+  uint8_t  filledBuffer = _activeBuffer;
+  uint16_t filledLength = _activeLength;
+
+  _bufferInFlight = true;
+  _activeBuffer   = filledBuffer ^ 1U;
+  _activeLength   = 0U;
+
+  bufferReady(_buffers[filledBuffer], filledLength);
+
+  return (STATUS_OK);
+}
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+TelemetryEncoder::TelemetryEncoder(uint8_t positionResolution)
+{
+  _positionResolution = positionResolution;
+  _positionShift      = 16U - positionResolution;
+}
+
+
+/**
+  * @brief   Appends one sample to the stream, handing the buffer over once full
+  *
+  * @warning Samples are dropped (and counted) if the active buffer is full while the
+  *          other is still in flight - the link is slower than the sample rate.
+  *
+  * @param   position:  Decoded encoder position
+  *
+  * @param   status:       Sample outcome, sent only when either status changes
+  *
+  * @param   deviceStatus: Encoder's own status field, sent with the outcome
+  *
+  * @param   timestamp:    Sample cycle count
+  *
+  * @retval  status_t: STATUS_ERROR if the sample was dropped
+  */
+status_t TelemetryEncoder::addSample(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp)
+{
+  if ((TELEMETRY_BUFFER_SIZE - _activeLength) < TELEMETRY_MAX_RECORD_SIZE)
+  {
+    if (swapBuffers() != STATUS_OK)
+    {
+      _droppedSamples++;
+      return (STATUS_ERROR);
+    }
+  }
+
+  /* Every buffer opens with a keyframe so a lost buffer only loses its own samples */
+  if ((_activeLength == 0U) || (_samplesSinceKey >= TELEMETRY_KEYFRAME_INTERVAL))
+  {
+    writeKeyframe(position, status, deviceStatus, timestamp);
+  }
+  else
+  {
+    writeDelta(position, status, deviceStatus, timestamp);
+  }
+
+  _lastPosition     = position;
+  _lastStatus       = status;
+  _lastDeviceStatus = deviceStatus;
+  _lastTimestamp    = timestamp;
+
+  return (STATUS_OK);
+}
+
+
+/**
+  * @brief   Hands over a partly filled buffer, e.g. before the link goes idle
+  *
+  * @warning Must run in the same context as addSample(), or with it masked
+  *
+  * @param   None
+  *
+  * @retval  status_t: STATUS_ERROR if the other buffer is still in flight
+  */
+status_t TelemetryEncoder::flush(void)
+{
+  if (_activeLength == 0U)
+  {
+    return (STATUS_OK);
+  }
+
+  return (swapBuffers());
+}
+
+
+void TelemetryEncoder::releaseBuffer(void)
+{
+  _bufferInFlight = false;
+}
+
+
+uint32_t TelemetryEncoder::getDroppedSampleCount(void)
+{
+  return (_droppedSamples);
+}
+
+
+/**
+  * @}End of File
+  */
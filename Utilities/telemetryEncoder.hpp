@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    telemetryEncoder.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and function prototypes
+  *          for compressing encoder samples into a compact telemetry stream.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __telemetryEncoder_H
+#define __telemetryEncoder_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+#include "utilities.hpp"
+#include "telemetryFormat.hpp"
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class TelemetryEncoder
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  TelemetryEncoder(uint8_t positionResolution);
+
+  virtual ~TelemetryEncoder() {};
+
+  status_t addSample(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp);
+
+  status_t flush(void);
+
+  void releaseBuffer(void);
+
+  uint32_t getDroppedSampleCount(void);
+
+  private:
+
+  /*-- Private Constants ------------------------------------------------------------*/
+
+  static const uint16_t TELEMETRY_BUFFER_SIZE       = 256U;
+  static const uint16_t TELEMETRY_KEYFRAME_INTERVAL = 256U;
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  uint8_t           _positionResolution;
+  uint8_t           _positionShift;
+
+  /* Double buffer - one is filled while the other is out on the link */
+  uint8_t           _buffers[2][TELEMETRY_BUFFER_SIZE];
+  uint8_t           _activeBuffer       = 0U;
+  uint16_t          _activeLength       = 0U;
+  volatile bool     _bufferInFlight     = false;
+
+  uint16_t          _lastPosition       = 0U;
+  uint8_t           _lastStatus         = 0U;
+  uint8_t           _lastDeviceStatus   = 0U;
+  uint32_t          _lastTimestamp      = 0U;
+  uint32_t          _lastTimestampDelta = 0U;
+  uint16_t          _samplesSinceKey    = 0U;
+
+  uint32_t          _droppedSamples     = 0U;
+
+  /*-- Private Prototypes -----------------------------------------------------------*/
+
+  void writeKeyframe(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp);
+
+  void writeDelta(uint16_t position, uint8_t status, uint8_t deviceStatus, uint32_t timestamp);
+
+  status_t swapBuffers(void);
+
+  /* Callback to derived class to start sending a filled buffer (e.g. by UART DMA) - call releaseBuffer() once sent.
+   * Runs in whatever context calls addSample(), which for an encoder's attached stream is its bus completion
+   * ISR - so it may only start the transfer, never block waiting for the link */
+  virtual void bufferReady(const uint8_t* buffer, uint16_t length) = 0;
+
+};
+
+
+#endif /* __telemetryEncoder_H */
+
+/**
+  * @}End of File
+  */
+
+
@@ -0,0 +1,220 @@
+/**
+  ******************************************************************************
+  * @file    telemetryFormat.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines and inline functions describing the compact
+  *          encoder telemetry stream. Kept free of HAL includes so the
+  *          host-side decoder can share it with the target encoder.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __telemetryFormat_H
+#define __telemetryFormat_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+/*
+ * The stream is a sequence of records, each starting with a varint header whose two
+ * low bits give the record type:
+ *
+ *   KEYFRAME      header = type
+ *                 u16 position, u8 status, u8 device status, u32 timestamp,
+ *                 u8 position resolution (little-endian)
+ *
+ *   DELTA         header = (zigzag(position delta) << 2) | type
+ *                 varint zigzag(timestamp delta-of-delta)
+ *
+ *   DELTA_STATUS  as DELTA, followed by a u8 status and a u8 device status
+ *
+ * Status is the driver's outcome for the sample (EncoderSampleStatus_t). Device status is
+ * the encoder's own status field (the Orbis error and warning bits) from the last frame
+ * which passed its CRC. Position deltas wrap at the position resolution. Both statuses are
+ * only sent when either changes, so runs of unchanged status cost nothing. Every buffer starts with a keyframe, so each
+ * one decodes on its own, and the timestamp delta restarts from zero after a keyframe.
+ */
+
+typedef enum: uint8_t
+{
+  TELEMETRY_RECORD_KEYFRAME     = 0U,
+  TELEMETRY_RECORD_DELTA        = 1U,
+  TELEMETRY_RECORD_DELTA_STATUS = 2U,
+} TelemetryRecordType_t;
+
+const uint8_t TELEMETRY_RECORD_TYPE_BITS = 2U;
+const uint8_t TELEMETRY_RECORD_TYPE_MASK = (1U << TELEMETRY_RECORD_TYPE_BITS) - 1U;
+
+const uint8_t TELEMETRY_KEYFRAME_SIZE    = 10U;
+
+/* Largest record: 3 byte delta header, 2 status bytes, 5 byte timestamp varint */
+const uint8_t TELEMETRY_MAX_RECORD_SIZE  = 10U;
+
+const uint8_t VARINT_PAYLOAD_BITS        = 7U;
+const uint8_t VARINT_CONTINUE            = 0x80U;
+
+/*************************************************************************************/
+/* PUBLIC TYPEDEFS                                                                   */
+/*************************************************************************************/
+
+/* Decoder's running sample - holds the latest decoded sample once synchronised */
+typedef struct
+{
+  uint16_t position;
+  uint8_t  status;
+  uint8_t  deviceStatus;
+  uint32_t timestamp;
+  uint32_t timestampDelta;
+  uint16_t positionMask;
+  bool     synchronised;
+
+} TelemetryDecoderState_t;
+
+const TelemetryDecoderState_t TELEMETRY_DECODER_INITIAL_STATE = { 0U, 0U, 0U, 0U, 0U, 0xFFFFU, false };
+
+/*************************************************************************************/
+/* INLINE FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+static inline uint32_t zigzagEncode(int32_t value)
+{
+  return ((static_cast<uint32_t>(value) << 1U) ^ static_cast<uint32_t>(value >> 31U));
+}
+
+static inline int32_t zigzagDecode(uint32_t value)
+{
+  return (static_cast<int32_t>(value >> 1U) ^ -static_cast<int32_t>(value & 1U));
+}
+
+static inline uint8_t varintWrite(uint8_t* byteBuffer, uint32_t value)
+{
+  uint8_t length = 0U;
+
+  while (value >= VARINT_CONTINUE)
+  {
+    byteBuffer[length++] = static_cast<uint8_t>(value | VARINT_CONTINUE);
+    value >>= VARINT_PAYLOAD_BITS;
+  }
+
+  byteBuffer[length++] = static_cast<uint8_t>(value);
+
+  return (length);
+}
+
+/* Returns bytes consumed, or 0 if the varint runs past the end of the buffer */
+static inline uint8_t varintRead(const uint8_t* byteBuffer, uint32_t available, uint32_t* value)
+{
+  uint32_t result = 0U;
+
+  for (uint8_t length = 0U; (length < available) && (length < 5U); length++)
+  {
+    result |= static_cast<uint32_t>(byteBuffer[length] & ~VARINT_CONTINUE) << (length * VARINT_PAYLOAD_BITS);
+
+    if ((byteBuffer[length] & VARINT_CONTINUE) == 0U)
+    {
+      *value = result;
+      return (length + 1U);
+    }
+  }
+
+  return (0U);
+}
+
+/* Decodes one record into state, returning bytes consumed or 0 on a truncated/corrupt record.
+ * Deltas before the first keyframe have no reference, so state stays unsynchronised until one */
+static inline uint32_t decodeTelemetryRecord(const uint8_t* record, uint32_t available, TelemetryDecoderState_t* state)
+{
+  uint32_t header;
+  uint32_t length = varintRead(record, available, &header);
+
+  if (length == 0U)
+  {
+    return (0U);
+  }
+
+  uint8_t recordType = header & TELEMETRY_RECORD_TYPE_MASK;
+
+  if (recordType == TELEMETRY_RECORD_KEYFRAME)
+  {
+    if (available < TELEMETRY_KEYFRAME_SIZE)
+    {
+      return (0U);
+    }
+
+    state->position       = static_cast<uint16_t>(record[1] | (record[2] << 8U));
+    state->status         = record[3];
+    state->deviceStatus   = record[4];
+    state->timestamp      = static_cast<uint32_t>(record[5])         | (static_cast<uint32_t>(record[6]) << 8U) |
+                            (static_cast<uint32_t>(record[7]) << 16U) | (static_cast<uint32_t>(record[8]) << 24U);
+    state->positionMask   = static_cast<uint16_t>((1UL << record[9]) - 1U);
+    state->timestampDelta = 0U;
+    state->synchronised   = true;
+
+    length = TELEMETRY_KEYFRAME_SIZE;
+  }
+
+  else if ((recordType == TELEMETRY_RECORD_DELTA) || (recordType == TELEMETRY_RECORD_DELTA_STATUS))
+  {
+    uint32_t deltaOfDelta;
+    uint32_t timestampLength = varintRead(&record[length], available - length, &deltaOfDelta);
+
+    if (timestampLength == 0U)
+    {
+      return (0U);
+    }
+
+    length += timestampLength;
+
+    if (recordType == TELEMETRY_RECORD_DELTA_STATUS)
+    {
+      if ((length + 2U) > available)
+      {
+        return (0U);
+      }
+
+      state->status       = record[length++];
+      state->deviceStatus = record[length++];
+    }
+
+    state->position        = static_cast<uint16_t>(state->position + zigzagDecode(header >> TELEMETRY_RECORD_TYPE_BITS)) & state->positionMask;
+    state->timestampDelta += static_cast<uint32_t>(zigzagDecode(deltaOfDelta));
+    state->timestamp      += state->timestampDelta;
+  }
+
+  else
+  {
+    return (0U);
+  }
+
+  return (length);
+}
+
+
+#endif /* __telemetryFormat_H */
+
+/**
+  * @}End of File
+  */
+
+
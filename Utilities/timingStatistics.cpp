@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @file    timingStatistics.cpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains online min/max/mean/standard deviation and histogram
+  *          tracking of cycle-count intervals, cheap enough to update from an ISR.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include "timingStatistics.hpp"
+
+/*************************************************************************************/
+/* PRIVATE FUNCTION DEFINITIONS                                                      */
+/*************************************************************************************/
+
+static uint32_t squareRoot(uint64_t value)
+{
+  uint64_t root = 0U;
+  uint64_t bit  = 1ULL << 62U;
+
+  while (bit > value)
+  {
+    bit >>= 2U;
+  }
+
+  while (bit != 0U)
+  {
+    if (value >= (root + bit))
+    {
+      value -= root + bit;
+      root   = (root >> 1U) + bit;
+    }
+    else
+    {
+      root >>= 1U;
+    }
+
+    bit >>= 2U;
+  }
+
+  return (static_cast<uint32_t>(root));
+}
+
+/*************************************************************************************/
+/* PUBLIC FUNCTION DEFINITIONS                                                       */
+/*************************************************************************************/
+
+/**
+  * @brief  Adds one interval to the statistics
+  *
+  * @param  interval: Interval in cycles
+  *
+  * @retval None
+  */
+void TimingStatistics::add(uint32_t interval)
+{
+  if (_count == 0U)
+  {
+    _shift   = interval;
+    _minimum = interval;
+    _maximum = interval;
+  }
+
+  if (interval < _minimum) _minimum = interval;
+  if (interval > _maximum) _maximum = interval;
+
+  int32_t difference = static_cast<int32_t>(interval - _shift);
+
+  _shiftedSum          += difference;
+  _shiftedSumOfSquares += static_cast<uint64_t>(static_cast<int64_t>(difference) * difference);
+  _count++;
+
+  /* Floor division so bins are the same width either side of the centre */
+  int32_t binWidth = static_cast<int32_t>(_histogramBinWidth);
+  int32_t binShift = (difference >= 0) ? (difference / binWidth) : -(((-difference) + binWidth - 1) / binWidth);
+  int32_t bin      = (TIMING_HISTOGRAM_BINS / 2) + binShift;
+
+  if (bin < 0)                      bin = 0;
+  if (bin >= TIMING_HISTOGRAM_BINS) bin = TIMING_HISTOGRAM_BINS - 1;
+
+  _histogram[bin]++;
+}
+
+
+/**
+  * @brief  Clears the statistics, re-centring the histogram on the next interval added
+  *
+  * @param  histogramBinWidth: Width of each histogram bin in cycles
+  *
+  * @retval None
+  */
+void TimingStatistics::reset(uint32_t histogramBinWidth)
+{
+  _count               = 0U;
+  _minimum             = 0U;
+  _maximum             = 0U;
+  _shift               = 0U;
+  _shiftedSum          = 0;
+  _shiftedSumOfSquares = 0U;
+  _histogramBinWidth   = (histogramBinWidth == 0U) ? 1U : histogramBinWidth;
+
+  for (uint8_t bin = 0U; bin < TIMING_HISTOGRAM_BINS; bin++)
+  {
+    _histogram[bin] = 0U;
+  }
+}
+
+
+/**
+  * @brief  Computes the summary of all intervals added since the last reset
+  *
+  * @param  None
+  *
+  * @retval TimingSummary_t: Count, extremes, mean, standard deviation and histogram in cycles
+  */
+TimingSummary_t TimingStatistics::summarise(void)
+{
+  TimingSummary_t summary = {};
+
+  summary.count             = _count;
+  summary.minimum           = _minimum;
+  summary.maximum           = _maximum;
+  summary.histogramCentre   = _shift;
+  summary.histogramBinWidth = _histogramBinWidth;
+
+  for (uint8_t bin = 0U; bin < TIMING_HISTOGRAM_BINS; bin++)
+  {
+    summary.histogram[bin] = _histogram[bin];
+  }
+
+  if (_count > 0U)
+  {
+    int64_t  shiftedMean   = _shiftedSum / _count;
+    uint64_t meanOfSquares = _shiftedSumOfSquares / _count;
+    uint64_t squaredMean   = static_cast<uint64_t>(shiftedMean * shiftedMean);
+
+    summary.mean              = static_cast<uint32_t>(_shift + shiftedMean);
+    summary.standardDeviation = squareRoot((meanOfSquares > squaredMean) ? (meanOfSquares - squaredMean) : 0U);
+  }
+
+  return (summary);
+}
+
+
+/**
+  * @}End of File
+  */
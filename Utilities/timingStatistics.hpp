@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    timingStatistics.hpp
+  *
+  * @author  D. Baines
+  *
+  * @brief   File contains defines, type declarations, and the class declaration
+  *          for online statistics over cycle-count intervals.
+  *
+  * @version v1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) D. Baines
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion --------------------------------------------*/
+#ifndef __timingStatistics_H
+#define __timingStatistics_H
+
+/*************************************************************************************/
+/* INCLUDES                                                                          */
+/*************************************************************************************/
+
+#include <stdint.h>
+
+/*************************************************************************************/
+/* PUBLIC CONSTANTS                                                                  */
+/*************************************************************************************/
+
+const uint8_t TIMING_HISTOGRAM_BINS = 16U;
+
+/*************************************************************************************/
+/* TYPEDEFS                                                                          */
+/*************************************************************************************/
+
+/*
+ * The histogram is centred on the first interval after a reset. Bin n counts intervals in
+ * [centre + (n - 8) * binWidth, centre + (n - 7) * binWidth), with the first and last bins
+ * also collecting everything beyond them.
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t minimum;
+  uint32_t maximum;
+  uint32_t mean;
+  uint32_t standardDeviation;
+  uint32_t histogramCentre;
+  uint32_t histogramBinWidth;
+  uint32_t histogram[TIMING_HISTOGRAM_BINS];
+
+} TimingSummary_t;
+
+/*************************************************************************************/
+/* PROTOTYPES/CLASS DEFINITIONS                                                      */
+/*************************************************************************************/
+
+class TimingStatistics
+{
+
+  public:
+
+  /*-- Public Prototypes ------------------------------------------------------------*/
+
+  constexpr TimingStatistics(uint32_t histogramBinWidth) : _histogramBinWidth((histogramBinWidth == 0U) ? 1U : histogramBinWidth) {}
+
+  void add(uint32_t interval);
+
+  void reset(uint32_t histogramBinWidth);
+
+  TimingSummary_t summarise(void);
+
+  private:
+
+  /*-- Private Variables ------------------------------------------------------------*/
+
+  uint32_t _count                              = 0U;
+  uint32_t _minimum                            = 0U;
+  uint32_t _maximum                            = 0U;
+
+  /* Sums are taken relative to the first interval so the squares stay small for steady rates */
+  uint32_t _shift                              = 0U;
+  int64_t  _shiftedSum                         = 0;
+  uint64_t _shiftedSumOfSquares                = 0U;
+
+  uint32_t _histogramBinWidth                  = 1U;
+  uint32_t _histogram[TIMING_HISTOGRAM_BINS]   = {0U};
+
+};
+
+
+#endif /* __timingStatistics_H */
+
+/**
+  * @}End of File
+  */
@@ -73,6 +73,56 @@ static inline void EXIT_CRITICAL_SECTION(uint32_t priority_mask)
     __set_PRIMASK(priority_mask);
 }
 
+static inline uint32_t GET_ACTIVE_PRIORITY()
+{
+    /* IPSR holds the running exception number - 0 in thread mode, which every interrupt preempts */
+    uint32_t exceptionNumber = __get_IPSR();
+
+    if (exceptionNumber == 0U)
+    {
+        return (1UL << __NVIC_PRIO_BITS);
+    }
+
+    return (NVIC_GetPriority(static_cast<IRQn_Type>(static_cast<int32_t>(exceptionNumber) - 16)));
+}
+
+static inline uint32_t ENTER_PRIORITY_CRITICAL_SECTION(uint32_t maskPriority)
+{
+    /* A caller above maskPriority is not masked against the others - it could preempt one inside the section */
+    assert_param(GET_ACTIVE_PRIORITY() >= maskPriority);
+
+    /* Mask only interrupts at maskPriority and below (numerically greater or equal) */
+    /* Higher priority interrupts keep running. maskPriority must be non-zero - BASEPRI cannot mask priority 0 */
+    /* BASEPRI_MAX only ever raises the mask, so nesting inside a stricter section is safe */
+    uint32_t basepri = __get_BASEPRI();
+    __set_BASEPRI_MAX(maskPriority << (8U - __NVIC_PRIO_BITS));
+    return (basepri);
+}
+
+static inline void EXIT_PRIORITY_CRITICAL_SECTION(uint32_t basepri)
+{
+    /* Restore the mask that was active on entry */
+    __set_BASEPRI(basepri);
+}
+
+
+/*************************************************************************************/
+/* CYCLE COUNTER FUNCTION DEFINITIONS                                                */
+/*************************************************************************************/
+
+static inline void ENABLE_CYCLE_COUNTER()
+{
+    /* DWT must be powered through the debug trace enable before its counter will run */
+    CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        = DWT->CTRL        | DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t GET_CYCLE_COUNT()
+{
+    /* Free running core clock counter - wraps, so only compare timestamps by unsigned difference */
+    return (DWT->CYCCNT);
+}
+
 
 #endif /* __utilities_H */
 